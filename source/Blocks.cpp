@@ -1,8 +1,11 @@
+#include <algorithm>
+#include <cstring>
 #include <unordered_set>
 
 #include <SFML/Graphics.hpp>
 
 #include "Blocks.hpp"
+#include "Effects.hpp"
 #include "Enemy.hpp"
 #include "Pickups.hpp"
 #include "SuperMarioGame.hpp"
@@ -12,13 +15,75 @@ namespace
 {
 
 const Vector BLOCK_SIZE(32, 32);
+const int STATIC_TILES_COLS = 8;
+const int ANIMATION_FRAMES = 4;
+const float ANIMATION_SPEED = 0.005f;
 static std::unordered_set<int> NIGHT_FILTER_EXCEPT = { 82,83,50,58,62,64 };
 
+/// Night view color transform: (r, g, b, a) -> (g, (r+g)/2, (r+g)/2, a).
+/// Plain byte loop without branches, compilers vectorize it.
+void nightViewFilter(uint8_t* pixels, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t* pixel = pixels + i * 4;
+        const uint8_t r = pixel[0];
+        const uint8_t g = pixel[1];
+        const uint8_t middle = static_cast<uint8_t>((r + g + 1) >> 1);
+        pixel[0] = g;
+        pixel[1] = middle;
+        pixel[2] = middle;
+    }
+}
+
+/// Build night variant of a tiles atlas, cells for which is_exempt() returns true are kept as is.
+sf::Texture* createNightTexture(const sf::Texture& source, const std::function<bool(int col, int row)>& is_exempt) {
+    const sf::Image image = source.copyToImage();
+    const sf::Vector2u size = image.getSize();
+    const int cell_w = BLOCK_SIZE.x;
+    const int cell_h = BLOCK_SIZE.y;
+    const size_t row_bytes = size.x * 4;
+
+    std::vector<uint8_t> pixels(image.getPixelsPtr(), image.getPixelsPtr() + row_bytes * size.y);
+    nightViewFilter(pixels.data(), size.x * size.y);
+
+    // restore exempt cells
+    for (unsigned y = 0; y < size.y; y += cell_h) {
+        for (unsigned x = 0; x < size.x; x += cell_w) {
+            if (!is_exempt(x / cell_w, y / cell_h)) {
+                continue;
+            }
+
+            const unsigned width = std::min<unsigned>(cell_w, size.x - x);
+            const unsigned height = std::min<unsigned>(cell_h, size.y - y);
+
+            for (unsigned line = y; line < y + height; ++line) {
+                const size_t offset = line * row_bytes + x * 4;
+                std::memcpy(pixels.data() + offset, image.getPixelsPtr() + offset, width * 4);
+            }
+        }
+    }
+
+    auto texture = new sf::Texture();
+    if (!texture->resize(size)) {
+        LOG("Blocks", ERROR, "Failed to create night tiles texture");
+    }
+    texture->update(pixels.data());
+    return texture;
+}
+
+const sf::Texture* nightTexture(const std::string& name, const std::function<bool(int col, int row)>& is_exempt) {
+    auto& textures = MARIO_GAME.textureManager();
+    const std::string night_name = name + "Night";
+
+    if (!textures.contains(night_name)) {
+        textures.add(night_name, createNightTexture(*textures.get(name), is_exempt));
+    }
+
+    return textures.get(night_name);
+}
+
 } // anonymous namespace
 
-SpriteSheet AbstractBlock::s_questionBlockSprite = SpriteSheet();
-SpriteSheet AbstractBlock::s_waterSprite = SpriteSheet();
-SpriteSheet AbstractBlock::s_lavaSprite = SpriteSheet();
+SpriteSheet AbstractBlock::s_animatedTiles = SpriteSheet();
 SpriteSheet AbstractBlock::s_staticTiles = SpriteSheet();
 
 AbstractBlock::AbstractBlock(TileCode id)
@@ -27,7 +92,7 @@ AbstractBlock::AbstractBlock(TileCode id)
     , m_colliable(0) {
 
     if (s_staticTiles.empty()) {
-        s_staticTiles.load(*MARIO_GAME.textureManager().get("Tiles"), Vector::ZERO, BLOCK_SIZE, 8, 12);
+        s_staticTiles.load(*MARIO_GAME.textureManager().get("Tiles"), Vector::ZERO, BLOCK_SIZE, STATIC_TILES_COLS, 12);
     }
 
     auto idNum = static_cast<int>(id);
@@ -35,10 +100,15 @@ AbstractBlock::AbstractBlock(TileCode id)
 }
 
 void AbstractBlock::init() {
+    // the sheet is shared by all levels, only the first Blocks instance loads it
+    static bool s_initialized = false;
+    if (s_initialized) {
+        return;
+    }
+    s_initialized = true;
+
     auto& atlas = *MARIO_GAME.textureManager().get("AnimTiles");
-    AbstractBlock::s_questionBlockSprite.load(atlas, { 0,0 }, BLOCK_SIZE, 4, 1, 0.005f);
-    AbstractBlock::s_waterSprite.load(atlas, { 0,32 }, BLOCK_SIZE, 4, 1, 0.005f);
-    AbstractBlock::s_lavaSprite.load(atlas, { 0,64 }, BLOCK_SIZE, 4, 1, 0.005f);
+    AbstractBlock::s_animatedTiles.load(atlas, Vector::ZERO, BLOCK_SIZE, ANIMATION_FRAMES, 3);
 }
 
 void AbstractBlock::killCharactersAbove(Character* attacker) {
@@ -84,6 +154,14 @@ TileCode AbstractBlock::code() const {
     return m_id;
 }
 
+TileCode AbstractBlock::displayCode() const {
+    return m_id;
+}
+
+float AbstractBlock::kickOffset() const {
+    return 0.f;
+}
+
 bool AbstractBlock::isInvisible() const {
     return m_invisible;
 }
@@ -99,46 +177,77 @@ bool isInvis(TileCode id) {
            (id == TileCode::INVIZ_LADDER);
 }
 
-void AbstractBlock::drawTileSprite(TileCode id, const Vector& pos, sf::RenderWindow* wnd) {
-    SpriteSheet* spriteSheet = nullptr;
-
+TileCode AbstractBlock::spriteCode(TileCode id) {
     switch (id)
     {
     case TileCode::INVIZ_UP:       // fall through
     case TileCode::INVIZ_COIN:     // fall through
     case TileCode::INVIZ_LADDER:
-        // skip drawing
-        return;
+        return TileCode::EMPTY;
     case TileCode::BRICK:          // fall through
     case TileCode::COIN_BOX:       // fall through
     case TileCode::BRICK_LADDER:   // fall through
     case TileCode::BRICK_LIVE_UP:  // fall through
     case TileCode::BRICK_MUSHROOM: // fall through
     case TileCode::BRICK_STAR:
-        id = TileCode::BRICK;
-        break;
+        return TileCode::BRICK;
+    default:
+        return id;
+    }
+}
+
+int AbstractBlock::animationRow(TileCode id) {
+    switch (id)
+    {
     case TileCode::QUESTION_ONE_COIN: // fall through
     case TileCode::QUESTION_MUSHROOM:
-        spriteSheet = &s_questionBlockSprite;
-        break;
+        return 0;
     case TileCode::WATER:
-        spriteSheet = &s_waterSprite;
-        break;
+        return 1;
     case TileCode::LAVA:
-        spriteSheet = &s_lavaSprite;
-        break;
+        return 2;
     default:
-        break;
+        return -1;
     }
+}
 
-    if (!spriteSheet)
-    {
+sf::IntRect AbstractBlock::tileTextureRect(TileCode id) {
+    const sf::Vector2i size(BLOCK_SIZE.x, BLOCK_SIZE.y);
+    const int row = animationRow(id);
+
+    if (row >= 0) { // first frame in AnimTiles
+        return { { 0, row * size.y }, size };
+    }
+
+    const int index = static_cast<int>(id) - 1;
+    return { { (index % STATIC_TILES_COLS) * size.x, (index / STATIC_TILES_COLS) * size.y }, size };
+}
+
+void AbstractBlock::drawTileSprite(TileCode id, const Vector& pos, Renderer* renderer) {
+    SpriteSheet* spriteSheet = nullptr;
+
+    id = spriteCode(id);
+
+    if (id == TileCode::EMPTY) {
+        // skip drawing
+        return;
+    }
+
+    const int row = animationRow(id);
+
+    if (row >= 0) {
+        spriteSheet = &s_animatedTiles;
+        spriteSheet->setSpriteIndex(row * ANIMATION_FRAMES + m_blocks->tileAnimationFrame() % ANIMATION_FRAMES);
+    } else {
         spriteSheet = &s_staticTiles;
         spriteSheet->setSpriteIndex(static_cast<int>(id) - 1);
     }
 
     spriteSheet->setPosition(pos);
-    spriteSheet->draw(wnd);
+    sf::RenderStates states;
+    states.texture = m_blocks->tilesTexture(row >= 0); // day or night variant
+
+    spriteSheet->draw(renderer, states);
 }
 //---------------------------------------------------------------------------
 //! StaticBlock
@@ -147,8 +256,8 @@ StaticBlock::StaticBlock(TileCode id)
     : AbstractBlock(id) {
 }
 
-void StaticBlock::draw(sf::RenderWindow* render_window) {
-    drawTileSprite(code(), m_position, render_window);
+void StaticBlock::draw(Renderer* renderer) {
+    drawTileSprite(code(), m_position, renderer);
 };
 
 void StaticBlock::hit(Mario* mario) {
@@ -161,10 +270,14 @@ BrickBlock::BrickBlock()
     : AbstractBlock(TileCode::BRICK) {
 }
 
-void BrickBlock::draw(sf::RenderWindow* render_window) {
-    drawTileSprite(code(), m_position + Vector::UP * m_kickedDiff, render_window);
+void BrickBlock::draw(Renderer* renderer) {
+    drawTileSprite(code(), m_position + Vector::UP * m_kickedDiff, renderer);
 };
 
+float BrickBlock::kickOffset() const {
+    return m_kickedDiff;
+}
+
 void BrickBlock::update(int delta_time) {
     if (m_kickedDir) {
         m_kickedDiff -= m_kickedDir * delta_time / 10;
@@ -194,7 +307,7 @@ void BrickBlock::hit(Mario* mario)
 
     if (!mario->isSmall()) { // crash box
         for (auto& brick : bricks) {
-            MARIO_GAME.spawnObject<OneBrick>(m_position + brick.first, brick.second);
+            MARIO_GAME.effects()->spawnBrickDebris(m_position + brick.first, brick.second);
         }
 
         m_blocks->clearBlock(static_cast<int>(x / BLOCK_SIZE.x), static_cast<int>(y / BLOCK_SIZE.y));
@@ -215,13 +328,19 @@ CoinBoxBlock::CoinBoxBlock(TileCode id)
     : AbstractBlock(id) {
 }
 
-void CoinBoxBlock::draw(sf::RenderWindow* render_window) {
-    auto id = m_coinLeft ? code()
-                         : TileCode::KICKED_BOX;
-
-    drawTileSprite(id, m_position + Vector::UP * m_kickedValue, render_window);
+void CoinBoxBlock::draw(Renderer* renderer) {
+    drawTileSprite(displayCode(), m_position + Vector::UP * m_kickedValue, renderer);
 };
 
+TileCode CoinBoxBlock::displayCode() const {
+    return m_coinLeft ? code()
+                      : TileCode::KICKED_BOX;
+}
+
+float CoinBoxBlock::kickOffset() const {
+    return m_kickedValue;
+}
+
 void CoinBoxBlock::update(int delta_time) {
     if (!m_kickedValue) {
         return;
@@ -248,7 +367,7 @@ void CoinBoxBlock::hit(Mario* mario)
         --m_coinLeft;
         Vector pos = m_position + Vector::UP * BLOCK_SIZE.y;
 
-        MARIO_GAME.spawnObject<TwistedCoin>(pos);
+        spawnTwistedCoin(pos);
         MARIO_GAME.addScore(100, pos);
         MARIO_GAME.addCoin();
         MARIO_GAME.playSound("bump");
@@ -268,15 +387,21 @@ QuestionBlock::QuestionBlock(TileCode id, PrizeFabricFunct prizeFabricFunct)
     setInvisible(isInvis(id));
 }
 
-void QuestionBlock::draw(sf::RenderWindow* render_window) {
+void QuestionBlock::draw(Renderer* renderer) {
     if (!isInvisible()) {
-        auto id = !m_kicked ? code()
-                            : TileCode::KICKED_BOX;
-
-        drawTileSprite(id, m_position + Vector::UP * m_kickedValue, render_window);
+        drawTileSprite(displayCode(), m_position + Vector::UP * m_kickedValue, renderer);
     }
 }
 
+TileCode QuestionBlock::displayCode() const {
+    return !m_kicked ? code()
+                     : TileCode::KICKED_BOX;
+}
+
+float QuestionBlock::kickOffset() const {
+    return m_kickedValue;
+}
+
 void QuestionBlock::hit(Mario* mario) {
     if (!m_kicked) {
         m_kickedValue = 1;
@@ -284,7 +409,9 @@ void QuestionBlock::hit(Mario* mario) {
         m_kicked = true;
         Vector pos = m_position + Vector::UP * BLOCK_SIZE.y;
         GameObject* object = m_prizeFabricFunct(pos);
-        MARIO_GAME.currentScene()->addChild(object);
+        if (object) {
+            MARIO_GAME.currentScene()->addChild(object);
+        }
         killCharactersAbove(mario);
     }
 
@@ -318,24 +445,28 @@ Background::Background()
 {
 }
 
-void Background::draw(sf::RenderWindow* render_window) {
+void Background::draw(Renderer* renderer) {
     if (m_background) {
-        render_window->draw(*m_background);
+        renderer->draw(*m_background);
     }
 }
 
 void Background::update(int delta_time) {
     Rect cameraRect = getParent()->castTo<MarioGameScene>()->cameraRect();
     setBounds(cameraRect);
-    m_background->setPosition(cameraRect.leftTop());
+    if (m_background) {
+        m_background->setPosition(cameraRect.leftTop());
+    }
 }
 
 void Background::onStarted() {
     const std::string picture_name = getProperty("Picture").asString();
     const bool nightViewOn = getProperty("NightViewFilter").isValid() && getProperty("NightViewFilter").asBool();
 
-    auto texture = MARIO_GAME.textureManager().get(picture_name);
-    m_background = std::make_unique<sf::Sprite>(*texture, sf::IntRect({0,0}, {1280, 720}));
+    m_texture = MARIO_GAME.textureManager().acquire(picture_name);
+    if (m_texture) {
+        m_background = std::make_unique<sf::Sprite>(*m_texture, sf::IntRect({0,0}, {1280, 720}));
+    }
 
     setSize({10, 10});
     getParent()->findChildObjectByType<Blocks>()->enableNightViewFilter(nightViewOn);
@@ -351,31 +482,44 @@ Blocks::Blocks(int cols, int rows, int tile_width, int tile_height) {
 
     AbstractBlock::init();
 
-    static const std::string frag_shader =
-        "#version 120\n"\
-        "uniform sampler2D texture;\n"\
-        "void main()"\
-        "{"\
-        "   vec4 color = texture2D(texture, gl_TexCoord[0].xy);"\
-        "   float middle = (color.r + color.g)/2.f;"\
-        "   gl_FragColor = vec4(color.g,middle,middle,color.a);"\
-        "}";
- 
-    m_nightViewFilterShader.loadFromMemory(frag_shader, sf::Shader::Type::Fragment);
-    m_nightViewFilterShader.setUniform("texture", sf::Shader::CurrentTexture);
+    m_tiles_texture = MARIO_GAME.textureManager().get("Tiles");
+    m_anim_tiles_texture = MARIO_GAME.textureManager().get("AnimTiles");
+    m_tile_renderer.setAnimationSpeed(ANIMATION_SPEED);
 }
 
-void Blocks::loadFromArray(const std::vector<char>& data, std::function<AbstractBlock*(char)> fabric) {
-   // m_tile_map->loadFromArray<char>(fabric, data);
+void Blocks::reserveStaticBlocks(size_t count) {
+    assert(m_static_blocks.empty()); // blocks must not move once created
+    m_static_blocks.reserve(count);
+}
+
+AbstractBlock* Blocks::createStaticBlock(TileCode id) {
+    if (m_static_blocks.size() < m_static_blocks.capacity()) {
+        return &m_static_blocks.emplace_back(id);
+    }
 
-    if (data.size() != m_tile_map->cols() * m_tile_map->rows()) {
+    return new StaticBlock(id);
+}
+
+void Blocks::destroyBlock(AbstractBlock* block) {
+    const bool pooled = !m_static_blocks.empty() &&
+                        block >= m_static_blocks.data() &&
+                        block < m_static_blocks.data() + m_static_blocks.size();
+
+    // pooled blocks are released together with the pool
+    if (!pooled) {
+        delete block;
+    }
+}
+
+void Blocks::loadFromArray(const uint16_t* data, size_t count, std::function<AbstractBlock*(uint16_t)> fabric) {
+    if (count != m_tile_map->cols() * m_tile_map->rows()) {
         throw std::runtime_error("Blocks - invalid data size");
     }
 
     int block_cols = m_tile_map->cols();
 
-    for (int i = 0; i < data.size(); ++i) {
-        char id = data[i];
+    for (int i = 0; i < count; ++i) {
+        const uint16_t id = data[i];
 
         if (!id) {
             continue;
@@ -395,63 +539,121 @@ void Blocks::loadFromArray(const std::vector<char>& data, std::function<Abstract
  
     setPosition({0, 0});
     setSize(m_tile_map->getRenderBounds().size());
+
+    m_tile_renderer.create(m_tile_map->cols(), m_tile_map->rows(), BLOCK_SIZE, LAYERS_COUNT,
+        [this](int x, int y, TileRenderer::Tile& tile) { return bakeTile(x, y, tile); });
+}
+
+bool Blocks::bakeTile(int x, int y, TileRenderer::Tile& tile) const {
+    AbstractBlock* block = m_tile_map->getTile(x, y);
+
+    // kicked blocks are drawn over the chunks until they settle down
+    if (!block || block->kickOffset()) {
+        return false;
+    }
+
+    TileCode id = AbstractBlock::spriteCode(block->displayCode());
+
+    if (id == TileCode::EMPTY) {
+        return false;
+    }
+
+    tile.texture_rect = AbstractBlock::tileTextureRect(id);
+
+    if (AbstractBlock::animationRow(id) >= 0) {
+        tile.frames = ANIMATION_FRAMES;
+        tile.layer = ANIMATED_LAYER;
+    } else {
+        tile.layer = STATIC_LAYER;
+    }
+
+    return true;
+}
+
+void Blocks::invalidateBlock(AbstractBlock* block) {
+    Vector cell = toBlockCoordinates(block->m_position);
+    m_tile_renderer.invalidate(cell.x, cell.y);
 }
 
 void Blocks::enableNightViewFilter(bool enable) {
     m_nightViewFilter = enable;
-}
 
-void Blocks::draw(sf::RenderWindow* render_window) {
-    if (m_nightViewFilter) {
-        sf::Shader::bind(&m_nightViewFilterShader);
+    auto& textures = MARIO_GAME.textureManager();
+
+    if (!enable) {
+        m_tiles_texture = textures.get("Tiles");
+        m_anim_tiles_texture = textures.get("AnimTiles");
+        return;
     }
 
+    // night atlases are generated once and shared by all night levels
+    m_tiles_texture = nightTexture("Tiles", [](int col, int row) {
+            return NIGHT_FILTER_EXCEPT.count(row * STATIC_TILES_COLS + col + 1) != 0;
+        });
+
+    m_anim_tiles_texture = nightTexture("AnimTiles", [](int, int row) {
+            for (int id : NIGHT_FILTER_EXCEPT) {
+                if (AbstractBlock::animationRow(static_cast<TileCode>(id)) == row) {
+                    return true;
+                }
+            }
+            return false;
+        });
+}
+
+const sf::Texture* Blocks::tilesTexture(bool animated) const {
+    return animated ? m_anim_tiles_texture : m_tiles_texture;
+}
+
+int Blocks::tileAnimationFrame() const {
+    return m_tile_renderer.animationFrame();
+}
+
+void Blocks::draw(Renderer* renderer) {
     Rect cameraRect = getParent()->castTo<MarioGameScene>()->cameraRect();
     const float block_size = blockSize().x;
-    Vector center = render_window->getView().getCenter();
-    Vector size = render_window->getView().getSize();
+    Vector center = renderer->getView().getCenter();
+    Vector size = renderer->getView().getSize();
  
     m_viewRect = Rect(toBlockCoordinates((center - size / 2)), toBlockCoordinates(size)).getIntersection(getRenderBounds());
     m_viewRect.setWidth(m_viewRect.width() + 2);
 
-    forEachVisibleBlock([=](AbstractBlock* block, int, int) {
-            int idNum = static_cast<int>(block->code());
-            bool skipFilter = m_nightViewFilter && NIGHT_FILTER_EXCEPT.count(idNum);
-
-            if (skipFilter)
-                sf::Shader::bind(nullptr);
-
-            block->draw(render_window);
-
-            if (skipFilter) {
-                sf::Shader::bind(&m_nightViewFilterShader);
-            }
-        });
-
-    GameObject::draw(render_window);
+    m_tile_renderer.draw(renderer, m_viewRect, STATIC_LAYER, sf::RenderStates(m_tiles_texture));
+    m_tile_renderer.draw(renderer, m_viewRect, ANIMATED_LAYER, sf::RenderStates(m_anim_tiles_texture));
 
-    if (m_nightViewFilter) {
-        sf::Shader::bind(nullptr);
+    // kicked blocks overlay, they never overlap each other
+    renderer->beginZRange();
+    for (auto block : m_kickedBlocks) {
+        block->draw(renderer);
     }
+    renderer->endZRange();
+
+    GameObject::draw(renderer);
 }
 
 void Blocks::update(int delta_time) {
     if (!m_removeLaterList.empty()) {
         for (auto object : m_removeLaterList) {
-            delete object;
+            destroyBlock(object);
         }
         m_removeLaterList.clear();
     }
 
     GameObject::update(delta_time);
 
-    AbstractBlock::s_questionBlockSprite.update(delta_time);
-    AbstractBlock::s_waterSprite.update(delta_time);
-    AbstractBlock::s_lavaSprite.update(delta_time);
+    m_tile_renderer.update(delta_time);
 
-    forEachVisibleBlock([=](AbstractBlock* block, int, int) {
-            block->update(delta_time);
-        });
+    // only kicked blocks have something to update
+    for (auto it = m_kickedBlocks.begin(); it != m_kickedBlocks.end();) {
+        (*it)->update(delta_time);
+
+        if (!(*it)->kickOffset()) {
+            invalidateBlock(*it);
+            it = m_kickedBlocks.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 Rect Blocks::getBlockBounds(const Vector& block) const {
@@ -467,8 +669,11 @@ AbstractBlock* Blocks::getBlock(int x, int y) {
 }
 
 void Blocks::clearBlock(int x, int y) {
-    m_removeLaterList.push_back(m_tile_map->getTile(x, y));
+    AbstractBlock* block = m_tile_map->getTile(x, y);
+    m_removeLaterList.push_back(block);
+    m_kickedBlocks.erase(std::remove(m_kickedBlocks.begin(), m_kickedBlocks.end(), block), m_kickedBlocks.end());
     m_tile_map->setTile(x, y, nullptr);
+    m_tile_renderer.invalidate(x, y);
 }
 
 void Blocks::hitBlock(int x, int y, Mario* mario) {
@@ -478,6 +683,18 @@ void Blocks::hitBlock(int x, int y, Mario* mario) {
     }
  
     block->hit(mario);
+
+    // hit may change the tile look (kicked box, revealed invisible block) or start kicking
+    m_tile_renderer.invalidate(x, y);
+
+    // a crashed brick is already cleared and queued for deletion, it must not be tracked again
+    if (getBlock(x, y) != block) {
+        return;
+    }
+
+    if (block->kickOffset() && std::find(m_kickedBlocks.begin(), m_kickedBlocks.end(), block) == m_kickedBlocks.end()) {
+        m_kickedBlocks.push_back(block);
+    }
 }
 
 int Blocks::rows() const {
@@ -565,26 +782,10 @@ Vector Blocks::collsionResponse(const Rect& body_rect, const Vector& body_speed,
     return new_pos;
 }
 
-void Blocks::forEachVisibleBlock(const std::function<void(AbstractBlock*, int, int)>& func) {
-    for (int x = m_viewRect.left(); x < m_viewRect.right(); ++x) {
-        for (int y = m_viewRect.top(); y < m_viewRect.bottom(); ++y) {
-            if (!m_tile_map->isTileInBounds(Vector(x, y))) {
-                continue;
-            }
-
-            AbstractBlock* block = m_tile_map->getTile(x, y);
-
-            if (block) {
-                func(block, x, y);
-            }
-        }
-    }
-}
-
 Blocks::~Blocks() {
     for (int x = 0; x < m_tile_map->cols(); ++x) {
         for (int y = 0; y < m_tile_map->rows(); ++y) {
-            delete m_tile_map->getTile(x, y);
+            destroyBlock(m_tile_map->getTile(x, y));
         }
     }
 
@@ -608,67 +809,20 @@ std::vector<Vector> Blocks::getBridgeBlocks() {
     return bridge_cells;
 }
 //---------------------------------------------------------------------------
-//! OneBrick
+//! Coin prize
 //---------------------------------------------------------------------------
-OneBrick::OneBrick(const Vector& pos, const Vector& speed_vector) {
-    setName("OneBrick");
-    setPosition(pos);
-    m_speed = speed_vector;
-    m_sprite_sheet.load(*MARIO_GAME.textureManager().get("Items"), { { {96,0},{16,16} }, { {96,16},{16,-16} } });
-
-    m_sprite_sheet.setAnimType(AnimType::FORWARD_CYCLE);
-    m_sprite_sheet.setSpeed(0.005f);
-}
-
-void OneBrick::draw(sf::RenderWindow* render_window) {
-    m_sprite_sheet.setPosition(getPosition());
-    m_sprite_sheet.draw(render_window);
-}
-
-void OneBrick::update(int delta_time)  {
-    m_sprite_sheet.update(delta_time);
-    m_speed.y += delta_time * 0.0005f; // gravity
-    move(m_speed*delta_time);
-    m_timer += delta_time;
-    if (m_timer > 3000) {
-       removeLater();
-    }
-}
-//---------------------------------------------------------------------------
-//! TwistedCoin
-//---------------------------------------------------------------------------
-TwistedCoin::TwistedCoin(const Vector& pos) {
-    auto& texture = *MARIO_GAME.textureManager().get("Items");
-    m_animator.create("twist", texture, Vector(0, 84), Vector(32, 32), 4, 1, 0.01f);
-    m_animator.create("shine", texture, Vector(0, 116), Vector(40, 32), 5, 1, 0.01f, AnimType::FORWARD);
-    m_animator.setOrigin("shine", {4, 0});
-
-    setPosition(pos);
-    m_speed = Vector::UP * 0.05f;
-    m_speed.y = -0.20f;
+void spawnTwistedCoin(const Vector& pos) {
+    MARIO_GAME.effects()->spawnTwistedCoin(pos);
     MARIO_GAME.addScore(100, pos);
     MARIO_GAME.addCoin();
+    MARIO_GAME.playSound("coin");
 }
 
-void TwistedCoin::draw(sf::RenderWindow* render_window) {
-    m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
-}
-
-void TwistedCoin::update(int delta_time) {
-    if (m_timer == 0) {
-        MARIO_GAME.playSound("coin");
-    } else if (m_timer < 700) {
-        m_speed.y += delta_time * 0.0005f; // gravity
-        move(m_speed * delta_time);
-    } else if (m_timer < 1200) {
-        m_animator.play("shine");
-    } else {
-        removeLater();
-    }
-
-    m_timer += delta_time;
-    m_animator.update(delta_time);
+PrizeFabricFunct coinPrize() {
+    return [](const Vector& pos) -> GameObject* {
+        spawnTwistedCoin(pos);
+        return nullptr;
+    };
 }
 
 template <>
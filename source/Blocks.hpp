@@ -5,6 +5,7 @@
 
 #include "GameEngine.hpp"
 #include "TileMap.hpp"
+#include "TileRenderer.hpp"
 #include "Items.hpp"
 #include "SuperMarioGame.hpp"
 
@@ -38,9 +39,11 @@ class AbstractBlock {
 public:
     AbstractBlock(TileCode id);
     virtual ~AbstractBlock();
-    virtual void draw(sf::RenderWindow* render_window) = 0;
+    virtual void draw(Renderer* renderer) = 0;
     virtual void update(int delta_time);
     virtual void hit(Mario* mario) = 0;
+    virtual TileCode displayCode() const;
+    virtual float kickOffset() const;
     void setPosition(const Vector& pos);
     bool isColliable() const;
     bool isInvisible() const;
@@ -48,21 +51,22 @@ public:
     TileCode code() const;
 
     static void init();
+    static TileCode spriteCode(TileCode id);
+    static int animationRow(TileCode id);
+    static sf::IntRect tileTextureRect(TileCode id);
 protected:
 
     void setInvisible(bool value);
     void killCharactersAbove(Character* attacker);
-    void drawTileSprite(TileCode id, const Vector& pos, sf::RenderWindow* wnd);
+    void drawTileSprite(TileCode id, const Vector& pos, Renderer* renderer);
     class Blocks* m_blocks = nullptr;
     Vector m_position;
 
 private:
 
     TileCode m_id = TileCode::EMPTY;
-    // animated tiles
-    static SpriteSheet s_questionBlockSprite;
-    static SpriteSheet s_waterSprite;
-    static SpriteSheet s_lavaSprite;
+    // animated tiles, one row per animation
+    static SpriteSheet s_animatedTiles;
     // static tiles
     static SpriteSheet s_staticTiles;
     bool m_invisible : 1;
@@ -74,16 +78,17 @@ private:
 class StaticBlock : public AbstractBlock {
 public:
     StaticBlock(TileCode id);
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void hit(Mario* mario) override;
 };
 
 class BrickBlock : public AbstractBlock {
 public:
     BrickBlock();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void hit(Mario* mario) override;
     void update(int delta_time) override;
+    float kickOffset() const override;
 
 private:
     float m_kickedDiff = 0;
@@ -93,9 +98,11 @@ private:
 class CoinBoxBlock : public AbstractBlock {
 public:
     CoinBoxBlock(TileCode id);
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void hit(Mario* mario) override;
     void update(int delta_time) override;
+    TileCode displayCode() const override;
+    float kickOffset() const override;
 
 private:
     int m_coinLeft = 5;
@@ -110,9 +117,11 @@ using PrizeFabricFunct = std::function<GameObject* (const Vector& pos)>;
 class QuestionBlock : public AbstractBlock {
 public:
     QuestionBlock(TileCode id, PrizeFabricFunct prizeFabricFunct);
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void hit(Mario* mario) override;
     void update(int delta_time) override;
+    TileCode displayCode() const override;
+    float kickOffset() const override;
 
 protected:
     PrizeFabricFunct m_prizeFabricFunct;
@@ -138,25 +147,45 @@ public:
     Rect getBlockBounds(const Vector& block) const;
     bool isBlockInBounds(const Vector& block) const;
     std::vector<Vector> getBridgeBlocks();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void clearBlock(int x, int y);
     void hitBlock(int x, int y, Mario* mario);
     void enableNightViewFilter(bool enable);
-    void loadFromArray(const std::vector<char>& data, std::function<AbstractBlock* (char)> fabric);
+    int tileAnimationFrame() const;
+    const sf::Texture* tilesTexture(bool animated) const;
+    /*
+     * @brief Preallocate static blocks, they are constructed in one array instead of one by one
+     */
+    void reserveStaticBlocks(size_t count);
+    AbstractBlock* createStaticBlock(TileCode id);
+    void loadFromArray(const uint16_t* data, size_t count, std::function<AbstractBlock* (uint16_t)> fabric);
     bool isCollidableBlock(const Vector& block) const;
     bool isInvizibleBlock(const Vector& block) const;
     Vector collsionResponse(const Rect& body_rect, const Vector& body_speed, float delta_time, ECollisionTag& collision_tag);
 
 private:
 
-    void forEachVisibleBlock(const std::function<void(AbstractBlock*, int, int)>& func);
+    enum TileLayer {
+        STATIC_LAYER   = 0, //!< Tiles texture
+        ANIMATED_LAYER = 1, //!< AnimTiles texture
+        LAYERS_COUNT
+    };
+
+    bool bakeTile(int x, int y, TileRenderer::Tile& tile) const;
+    void invalidateBlock(AbstractBlock* block);
     Rect m_viewRect;
     TileMap<AbstractBlock*>* m_tile_map;
+    TileRenderer m_tile_renderer;
+    const sf::Texture* m_tiles_texture = nullptr;
+    const sf::Texture* m_anim_tiles_texture = nullptr;
     //sf::RectangleShape m_shape;
-    sf::Shader m_nightViewFilterShader;
     bool m_nightViewFilter = false;
+    void destroyBlock(AbstractBlock* block);
+
+    std::vector<StaticBlock> m_static_blocks;   //!< pool, capacity is never exceeded
     std::vector<AbstractBlock*> m_removeLaterList;
+    std::vector<AbstractBlock*> m_kickedBlocks; //!< bouncing blocks, drawn over the baked chunks
 };
 
 class Background : public GameObject {
@@ -164,38 +193,19 @@ class Background : public GameObject {
 
 public:
     Background();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
 
 private:
     void onStarted() override;
+    TextureManager::Handle m_texture;  //!< keeps the picture resident while the level is alive
     std::unique_ptr<sf::Sprite> m_background;
 };
 
-class OneBrick : public GameObject {
- public:
-    OneBrick(const Vector& pos, const Vector& speed_vector);
-    void draw(sf::RenderWindow* render_window) override;
-    void update(int delta_time) override;
-
- private:
-    Vector m_speed;
-    SpriteSheet m_sprite_sheet;
-    int m_timer = 0;
-};
-
-
-class TwistedCoin : public GameObject {
-public:
-    TwistedCoin(const Vector& pos);
-    void draw(sf::RenderWindow* render_window) override;
-    void update(int delta_time) override;
-
-private:
-    Vector m_speed;
-    Animator m_animator;
-    int m_timer = 0;
-};
+/*
+ * @brief Coin popping out of a block: twisted coin effect, score and coin counter
+ */
+void spawnTwistedCoin(const Vector& pos);
 
 //---------------------------------------------------------------------------
 // Inline Functions
@@ -223,4 +233,9 @@ class Mushroom;
 template <>
 PrizeFabricFunct prize<Mushroom>();
 
+/*
+ * @brief Coin prize is an effect only, it produces no scene object
+ */
+PrizeFabricFunct coinPrize();
+
 #endif // BLOCKS_HPP
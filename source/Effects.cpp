@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "Effects.hpp"
+#include "SuperMarioGame.hpp"
+
+namespace {
+    struct EffectInfo {
+        int lifetime;        //!< ms
+        float gravity;
+        float frame_speed;   //!< frames per ms
+        bool cycle;
+        int frames_count;
+        sf::IntRect frames[5];
+        Vector origin;
+    };
+
+    // indexed by Effects::Type
+    const EffectInfo EFFECTS[] = {
+        // SCORE_TEXT, fades out while flying up
+        { 1275, 0.f, 0.f, false, 0, {}, Vector(0, 0) },
+        // BRICK_DEBRIS, second frame is the vertically flipped first one
+        { 3000, 0.0005f, 0.005f, true, 2,
+          { { {96, 0}, {16, 16} }, { {96, 16}, {16, -16} } }, Vector(0, 0) },
+        // COIN_TWIST, turns into COIN_SHINE at the end
+        { 700, 0.0005f, 0.01f, true, 4,
+          { { {0, 84}, {32, 32} }, { {32, 84}, {32, 32} }, { {64, 84}, {32, 32} }, { {96, 84}, {32, 32} } }, Vector(0, 0) },
+        // COIN_SHINE
+        { 500, 0.f, 0.01f, false, 5,
+          { { {0, 116}, {40, 32} }, { {40, 116}, {40, 32} }, { {80, 116}, {40, 32} }, { {120, 116}, {40, 32} },
+            { {160, 116}, {40, 32} } }, Vector(4, 0) }
+    };
+
+    const Vector SCORE_TEXT_SPEED = { 0.f, -0.09f };
+    const sf::Color SCORE_TEXT_COLOR(255, 0, 0);
+    const float BOUNDS_MARGIN = 48.f;
+
+    const EffectInfo& info(Effects::Type type) {
+        return EFFECTS[static_cast<int>(type)];
+    }
+}
+
+Effects::Effects() {
+    setName("Effects");
+    m_texture = MARIO_GAME.textureManager().get("Items");
+
+    if (auto font = MARIO_GAME.fontManager().get("main_font")) {
+        m_font = &BitmapFont::get(*font, 14, sf::Text::Bold);
+    }
+}
+
+int Effects::spawn(Type type, const Vector& pos, const Vector& speed) {
+    if (m_count == CAPACITY) {
+        return -1;
+    }
+
+    const size_t index = m_count++;
+    m_type[index] = type;
+    m_x[index] = pos.x;
+    m_y[index] = pos.y;
+    m_speed_x[index] = speed.x;
+    m_speed_y[index] = speed.y;
+    m_time[index] = 0;
+    m_text[index][0] = '\0';
+    return static_cast<int>(index);
+}
+
+void Effects::remove(size_t index) {
+    // order doesn't matter, the last one takes the freed slot
+    const size_t last = --m_count;
+    m_type[index] = m_type[last];
+    m_x[index] = m_x[last];
+    m_y[index] = m_y[last];
+    m_speed_x[index] = m_speed_x[last];
+    m_speed_y[index] = m_speed_y[last];
+    m_time[index] = m_time[last];
+    m_text[index] = m_text[last];
+}
+
+void Effects::spawnText(const Vector& pos, const std::string& text) {
+    const int index = spawn(Type::SCORE_TEXT, pos, SCORE_TEXT_SPEED);
+    if (index < 0) {
+        return;
+    }
+
+    const size_t length = std::min(text.size(), MAX_TEXT_LENGTH);
+    std::memcpy(m_text[index].data(), text.data(), length);
+    m_text[index][length] = '\0';
+}
+
+void Effects::spawnBrickDebris(const Vector& pos, const Vector& speed) {
+    spawn(Type::BRICK_DEBRIS, pos, speed);
+}
+
+void Effects::spawnTwistedCoin(const Vector& pos) {
+    spawn(Type::COIN_TWIST, pos, Vector(0.f, -0.2f));
+}
+
+size_t Effects::activeCount() const {
+    return m_count;
+}
+
+Rect Effects::getBounds() const {
+    return m_bounds;
+}
+
+void Effects::update(int delta_time) {
+    float min_x = std::numeric_limits<float>::max();
+    float min_y = std::numeric_limits<float>::max();
+    float max_x = std::numeric_limits<float>::lowest();
+    float max_y = std::numeric_limits<float>::lowest();
+
+    for (size_t i = 0; i < m_count;) {
+        const EffectInfo& effect = info(m_type[i]);
+
+        m_time[i] += delta_time;
+        m_speed_y[i] += delta_time * effect.gravity;
+        m_x[i] += m_speed_x[i] * delta_time;
+        m_y[i] += m_speed_y[i] * delta_time;
+
+        if (m_time[i] >= effect.lifetime) {
+            if (m_type[i] != Type::COIN_TWIST) {
+                remove(i);
+                continue;
+            }
+
+            m_type[i] = Type::COIN_SHINE;
+            m_time[i] -= effect.lifetime;
+            m_speed_x[i] = m_speed_y[i] = 0.f;
+        }
+
+        min_x = std::min(min_x, m_x[i]);
+        min_y = std::min(min_y, m_y[i]);
+        max_x = std::max(max_x, m_x[i]);
+        max_y = std::max(max_y, m_y[i]);
+        ++i;
+    }
+
+    m_bounds = m_count ? Rect(min_x - BOUNDS_MARGIN, min_y - BOUNDS_MARGIN,
+                              max_x - min_x + 2 * BOUNDS_MARGIN, max_y - min_y + 2 * BOUNDS_MARGIN)
+                       : Rect();
+}
+
+void Effects::draw(Renderer* renderer) {
+    // sprites first, texts on top: two batches whatever the spawn order
+    for (size_t i = 0; i < m_count; ++i) {
+        if (m_type[i] != Type::SCORE_TEXT) {
+            drawSprite(renderer, i);
+        }
+    }
+
+    for (size_t i = 0; i < m_count; ++i) {
+        if (m_type[i] == Type::SCORE_TEXT) {
+            drawText(renderer, i);
+        }
+    }
+}
+
+void Effects::drawSprite(Renderer* renderer, size_t index) {
+    if (!m_texture) {
+        return;
+    }
+
+    const EffectInfo& effect = info(m_type[index]);
+    int frame = static_cast<int>(m_time[index] * effect.frame_speed);
+    frame = effect.cycle ? frame % effect.frames_count
+                         : std::min(frame, effect.frames_count - 1);
+
+    const sf::IntRect& rect = effect.frames[frame];
+    const sf::FloatRect quad({ m_x[index] - effect.origin.x, m_y[index] - effect.origin.y },
+                             { static_cast<float>(std::abs(rect.size.x)), static_cast<float>(std::abs(rect.size.y)) });
+
+    renderer->drawQuad(quad, sf::FloatRect(rect), sf::Color::White, sf::RenderStates(m_texture));
+}
+
+void Effects::drawText(Renderer* renderer, size_t index) {
+    if (!m_font) {
+        return;
+    }
+
+    sf::Color color = SCORE_TEXT_COLOR;
+    color.a = static_cast<uint8_t>(255 - std::min(255, static_cast<int>(m_time[index] * 0.2f)));
+
+    const sf::RenderStates states(&m_font->getTexture());
+    sf::Vector2f pen(m_x[index], m_y[index] + m_font->getCharacterSize());
+    char32_t previous = 0;
+
+    for (const char* c = m_text[index].data(); *c; ++c) {
+        const char32_t code = static_cast<unsigned char>(*c);
+        const BitmapFont::Glyph& glyph = m_font->getGlyph(code);
+        pen.x += m_font->getKerning(previous, code);
+        previous = code;
+
+        if (glyph.texture_rect.size.x > 0) {
+            renderer->drawQuad(sf::FloatRect(pen + glyph.bounds.position, glyph.bounds.size),
+                               sf::FloatRect(glyph.texture_rect), color, states);
+        }
+
+        pen.x += glyph.advance;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef EFFECTS_HPP
+#define EFFECTS_HPP
+
+#include <array>
+
+#include "GameEngine.hpp"
+
+/// @brief Scene owned pool of short-lived visual effects.
+///
+/// Score popups, brick debris and twisted coins are plain records in fixed
+/// capacity arrays instead of scene objects, spawning one doesn't allocate.
+/// All effects are updated in one pass and drawn as one sprite batch and one
+/// text batch. When the pool is full new effects are dropped.
+class Effects : public GameObject {
+public:
+    static constexpr size_t CAPACITY = 128;
+    static constexpr size_t MAX_TEXT_LENGTH = 7;
+
+    enum class Type : uint8_t {
+        SCORE_TEXT,
+        BRICK_DEBRIS,
+        COIN_TWIST,
+        COIN_SHINE
+    };
+
+    Effects();
+    void spawnText(const Vector& pos, const std::string& text);
+    void spawnBrickDebris(const Vector& pos, const Vector& speed);
+    void spawnTwistedCoin(const Vector& pos);
+    size_t activeCount() const;
+    Rect getBounds() const override;
+    void update(int delta_time) override;
+    void draw(Renderer* renderer) override;
+
+private:
+    int spawn(Type type, const Vector& pos, const Vector& speed);
+    void remove(size_t index);
+    void drawSprite(Renderer* renderer, size_t index);
+    void drawText(Renderer* renderer, size_t index);
+
+    size_t m_count = 0;
+    std::array<Type, CAPACITY> m_type;
+    std::array<float, CAPACITY> m_x;
+    std::array<float, CAPACITY> m_y;
+    std::array<float, CAPACITY> m_speed_x;
+    std::array<float, CAPACITY> m_speed_y;
+    std::array<int, CAPACITY> m_time;
+    std::array<std::array<char, MAX_TEXT_LENGTH + 1>, CAPACITY> m_text;
+
+    Rect m_bounds;
+    const sf::Texture* m_texture = nullptr;
+    const BitmapFont* m_font = nullptr;
+};
+
+#endif // EFFECTS_HPP
@@ -1,6 +1,10 @@
+#include <algorithm>
 #include <assert.h>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <future>
+#include <thread>
 
 #include <Format.hpp>
 #include "GameEngine.hpp"
@@ -14,6 +18,35 @@ int sign(float value) {
 
 } // namespace math
 
+namespace {
+
+uint32_t packColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    const uint8_t bytes[4] = { r, g, b, a };
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+/// Remap RGBA pixels, the first matching color wins (colors are walked backwards).
+/// Branchless select per color, so the inner loop auto-vectorizes.
+void remapPixels(uint32_t* pixels, size_t count, const uint32_t* from, const uint32_t* to, size_t colors) {
+    const uint32_t rgb_mask = packColor(0xff, 0xff, 0xff, 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t pixel = pixels[i];
+        const uint32_t rgb = pixel & rgb_mask;
+        uint32_t out = pixel;
+
+        for (size_t c = colors; c-- > 0;) {
+            out = (rgb == from[c]) ? (to[c] | (pixel & ~rgb_mask)) : out;
+        }
+
+        pixels[i] = out;
+    }
+}
+
+} // anonymous namespace
+
 
 
 void EventManager::pushEvent(const sf::Event& event) {
@@ -42,7 +75,6 @@ Game::Game(const std::string& name, const Vector& screen_size) {
     m_root_object = new GameObject();
     m_root_object->setName(name);
     m_screen_size = screen_size;
-    m_activeSounds.resize(256);
 }
 
 void Game::updateStats(const sf::Time time) {
@@ -74,6 +106,8 @@ void Game::run() {
 
     sf::Clock clock;
     sf::Time acumulator = sf::Time::Zero;
+    sf::Time capture_time = sf::Time::Zero;
+    bool first_frame = true;
     const sf::Time ups = sf::seconds(1.f / 60.f);
     //m_window->setFramerateLimit(60);
     //m_window->setVerticalSyncEnabled(true);
@@ -85,6 +119,12 @@ void Game::run() {
         // pull mouse, keyboard events
         while (const std::optional event = m_window->pollEvent()) {
             if (event->is<sf::Event::Closed>()) {
+                logResolutionStats();
+                logRenderStats();
+                logResourceStats();
+                m_voice_manager.logStats();
+                m_music_manager.logStats();
+                setFrameCapture("");
                 m_window->close();
                 exit(0);
             }
@@ -97,6 +137,14 @@ void Game::run() {
         acumulator += elapsedTime;
         //updateStats(elapsedTime);
 
+        // the whole last iteration is the frame period: its update ticks with their sleeps,
+        // the draw and display(), which blocks once the driver has enough frames queued.
+        // The capture is left out, it isn't the cost of the render scale
+        if (!first_frame) {
+            m_resolution_governor.addFrameTime((elapsedTime - capture_time).asMicroseconds() / 1000.f);
+        }
+        first_frame = false;
+
         while (acumulator > ups) {
             acumulator -= ups;
             inputManager().update(ups.asMilliseconds());
@@ -105,25 +153,248 @@ void Game::run() {
         }
 
         // draw
-        m_window->clear(m_clear_color);
-        draw(m_window.get());
+        if (m_software_backend) {
+            m_renderer.setBackend(m_software_backend.get());
+            drawFrame();
+            presentSoftwareFrame();
+        } else {
+            m_renderer.setTarget(m_window.get());
+            drawFrame();
+        }
+
+        // readback happens before display(), the back buffer is undefined after the swap
+        sf::Clock capture_clock;
+        captureFrame();
+        capture_time = capture_clock.getElapsedTime();
+
         m_window->display();
+        m_run_stats += m_render_stats;
+        ++m_run_frames;
     }
 }
 
+void Game::setFrameCapture(const std::string& path_pattern, unsigned every_nth) {
+    if (m_frame_capture) {
+        m_frame_capture->flush();
+        m_frame_capture->logStats();
+        m_frame_capture.reset();
+    }
+
+    if (!path_pattern.empty()) {
+        m_frame_capture = std::make_unique<FrameCapture>(path_pattern, every_nth);
+    }
+}
+
+FrameCapture* Game::frameCapture() {
+    return m_frame_capture.get();
+}
+
+void Game::captureFrame() {
+    if (!m_frame_capture || !m_frame_capture->nextFrame()) {
+        return;
+    }
+
+    if (m_software_backend) {
+        m_frame_capture->capture(*m_software_backend);
+    } else if (m_window) {
+        m_frame_capture->capture(*m_window);
+    }
+}
+
+void Game::logResolutionStats() const {
+    for (const auto& step : m_resolution_governor.getStats()) {
+        if (step.frames) {
+            LOG("GAME", INFO, "Render scale %.2f: %zu frames, %.1f s, avg frame %.2f ms",
+                step.scale, step.frames, step.seconds, step.seconds * 1000.0 / step.frames);
+        }
+    }
+    LOG("GAME", INFO, "Render scale %.2f now, %zu switches", m_resolution_governor.getScale(),
+        m_resolution_governor.getSwitchCount());
+}
+
+void Game::logRenderStats() const {
+    if (!m_run_frames) {
+        return;
+    }
+
+    const float frames = (float)m_run_frames;
+    LOG("GAME", INFO, "%zu frames. Per frame avg: draw calls %.1f, texture switches %.1f, quads %.1f",
+        m_run_frames, m_run_stats.draw_calls / frames, m_run_stats.texture_switches / frames, m_run_stats.quads / frames);
+}
+
+void Game::buildTextureAtlas(const std::vector<std::string>& names) {
+    std::vector<std::pair<std::string, const sf::Texture*>> sources;
+    for (const auto& name : names) {
+        // get() pins the texture, the atlas keeps pointers to its sources
+        if (const sf::Texture* texture = m_texture_manager.get(name)) {
+            sources.emplace_back(name, texture);
+        }
+    }
+
+    m_renderer.setAtlas(nullptr);
+    if (m_texture_atlas.build(sources)) {
+        m_texture_atlas.logStats();
+        m_renderer.setAtlas(&m_texture_atlas);
+    }
+}
+
+const TextureAtlas& Game::textureAtlas() const {
+    return m_texture_atlas;
+}
+
+void Game::logResourceStats() const {
+    auto log = [](const char* type, const auto& stats) {
+        LOG("GAME", INFO, "%-8s %3zu/%-3zu resident, %8.1f KB, budget %zu KB, %zu loads, %zu evictions", type,
+            stats.resident, stats.total, stats.resident_bytes / 1024.0, stats.budget / 1024, stats.loads, stats.evictions);
+    };
+
+    log("Textures", m_texture_manager.getStats());
+    log("Sounds", m_sound_manager.getStats());
+    log("Fonts", m_font_manager.getStats());
+    log("Music", m_music_manager.getStats());
+}
+
+void Game::setSoftwareRendering(bool enabled, float downscale, unsigned threads) {
+    // the scene render target is a GPU texture, the rasteriser has its own fixed downscale
+    m_resolution_governor.setEnabled(!enabled);
+
+    if (!enabled) {
+        m_texture_manager.setEvictionListener(nullptr);
+        m_software_backend.reset();
+        m_software_frame.reset();
+        return;
+    }
+
+    if (!threads) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const sf::Vector2u size((unsigned)(m_screen_size.x / downscale), (unsigned)(m_screen_size.y / downscale));
+    m_software_backend = std::make_unique<SoftwareRenderBackend>(size, threads);
+    m_software_backend->setDefaultView(sf::View(sf::FloatRect({ 0.f, 0.f }, { m_screen_size.x, m_screen_size.y })));
+
+    // pixels are cached by texture address, a texture reloaded after eviction may reuse it
+    m_texture_manager.setEvictionListener([this](const sf::Texture& texture) {
+        m_software_backend->invalidateTexture(texture);
+    });
+}
+
+void Game::presentSoftwareFrame() {
+    m_software_backend->finish();
+
+    const sf::Vector2u size = m_software_backend->getSize();
+    if (!m_software_frame) {
+        m_software_frame = std::make_unique<sf::Texture>();
+        if (!m_software_frame->resize(size)) {
+            LOG("GAME", ERROR, "Failed to create software frame texture");
+            return;
+        }
+    }
+
+    m_software_frame->update(reinterpret_cast<const std::uint8_t*>(m_software_backend->getPixels()));
+
+    sf::Sprite frame(*m_software_frame);
+    const sf::Vector2u window_size = m_window->getSize();
+    frame.setScale({ (float)window_size.x / size.x, (float)window_size.y / size.y });
+    m_window->setView(m_window->getDefaultView());
+    m_window->draw(frame);
+}
+
+void Game::runHeadless(int frames, const std::string& capture_path, unsigned every_nth) {
+    RecordingRenderBackend backend({ (unsigned)m_screen_size.x, (unsigned)m_screen_size.y });
+    if (!capture_path.empty() && !m_software_backend) {
+        setSoftwareRendering(true);
+    }
+
+    const bool sequence = (capture_path.find('%') != std::string::npos);
+    if (sequence) {
+        setFrameCapture(capture_path, every_nth);
+    }
+
+    m_renderer.setBackend(m_software_backend ? static_cast<RenderBackend*>(m_software_backend.get()) : &backend);
+    init();
+
+    const int frame_time = 1000 / 60;
+    RenderStats total, peak;
+
+    m_root_object->start();
+
+    // input isn't polled, there's no window to take focus
+    for (int frame = 0; frame < frames; ++frame) {
+        update(frame_time);
+        drawFrame();
+
+        if (sequence && m_frame_capture->nextFrame()) {
+            m_software_backend->finish();
+            m_frame_capture->capture(*m_software_backend);
+        }
+
+        total += m_render_stats;
+        peak.draw_calls = std::max(peak.draw_calls, m_render_stats.draw_calls);
+        peak.texture_switches = std::max(peak.texture_switches, m_render_stats.texture_switches);
+        peak.shader_switches = std::max(peak.shader_switches, m_render_stats.shader_switches);
+        peak.quads = std::max(peak.quads, m_render_stats.quads);
+        peak.vertices = std::max(peak.vertices, m_render_stats.vertices);
+    }
+
+    m_renderer.setBackend(nullptr);
+
+    if (sequence) {
+        setFrameCapture("");
+    } else if (m_software_backend && !capture_path.empty()) {
+        m_software_backend->finish();
+        sf::Image image;
+        m_software_backend->copyToImage(image);
+        if (!image.saveToFile(capture_path)) {
+            LOG("GAME", ERROR, "Failed to save frame to %s", capture_path.c_str());
+        }
+    }
+
+    if (frames > 0) {
+        LOG("GAME", INFO, "Headless run, %d frames. Per frame avg/peak: draw calls %.1f/%zu, texture switches %.1f/%zu, "
+                          "shader switches %.1f/%zu, quads %.1f/%zu",
+            frames,
+            (float)total.draw_calls / frames, peak.draw_calls,
+            (float)total.texture_switches / frames, peak.texture_switches,
+            (float)total.shader_switches / frames, peak.shader_switches,
+            (float)total.quads / frames, peak.quads);
+    }
+}
+
+void Game::drawFrame() {
+    m_renderer.clear(m_clear_color);
+    draw(&m_renderer);
+    m_renderer.flush();
+    m_render_stats = m_renderer.getStats();
+}
+
+const RenderStats& Game::renderStats() const {
+    return m_render_stats;
+}
+
+ResolutionGovernor& Game::resolutionGovernor() {
+    return m_resolution_governor;
+}
+
 GameObject* Game::getRootObject() {
     return m_root_object;
 }
 
-void Game::draw(sf::RenderWindow* render_window) {
-    m_root_object->draw(render_window);
+void Game::draw(Renderer* renderer) {
+    m_root_object->draw(renderer);
 }
 
 void Game::update(int delta_time) {
+    m_voice_manager.nextTick();
+    m_music_manager.update(delta_time);
     GameObject::invokePreupdateActions(); // remove obj, change z-oreder, etc
     m_root_object->update(delta_time);
 }
 
+AssetPack& Game::assetPack() {
+    return m_asset_pack;
+}
+
 TextureManager& Game::textureManager() {
     return m_texture_manager;
 }
@@ -144,12 +415,16 @@ InputManager& Game::inputManager() {
     return m_input_manager;
 }
 
+VoiceManager& Game::voiceManager() {
+    return m_voice_manager;
+}
+
 MusicManager& Game::musicManager() {
     return m_music_manager;
 }
 
-void Game::playMusic(const std::string& name) {
-    m_music_manager.play(name);
+void Game::playMusic(const std::string& name, int crossfade_ms) {
+    m_music_manager.play(name, crossfade_ms);
 }
 
 void Game::stopMusic() {
@@ -157,24 +432,16 @@ void Game::stopMusic() {
 }
 
 void Game::playSound(const std::string& name) {
-    const sf::SoundBuffer* soundBuff = soundManager().get(name);
-
-    // Circular buffer
-    size_t i = m_activeSoundSlot % m_activeSounds.size();
-    m_activeSoundSlot++;
-
-    auto& out = m_activeSounds[i];
-
-    if (out && out->getStatus() == sf::Sound::Status::Playing) {
-        return;
+    if (const sf::SoundBuffer* buffer = soundManager().get(name)) {
+        m_voice_manager.play(*buffer);
     }
-
-    auto& buffRef = *soundBuff;
-    out = std::make_unique<sf::Sound>(buffRef);
-    out->play();
 }
 
 Vector Game::screenSize() const {
+    if (!m_window) { // headless
+        return m_screen_size;
+    }
+
     return Vector((int)m_window->getSize().x, (int)m_window->getSize().y);
 }
 
@@ -226,6 +493,10 @@ bool SpriteSheet::empty() const {
     return m_sprites.empty();
 }
 
+const sf::Texture* SpriteSheet::getTexture() const {
+    return m_sprites.empty() ? nullptr : &m_sprites.front().getTexture();
+}
+
 void SpriteSheet::setSpriteIndex(int index) {
     assert(index >= 0 && index < m_sprites.size());
     m_current_sprite = &m_sprites[index];
@@ -240,68 +511,30 @@ void SpriteSheet::setAnimType(AnimType type) {
     m_index = 0;
 }
 
-void SpriteSheet::draw(sf::RenderWindow* wnd, int spriteIndex) {
+void SpriteSheet::draw(Renderer* renderer, int spriteIndex) {
     auto& sprite = m_sprites[spriteIndex];
     sprite.setPosition(m_position);
-    wnd->draw(sprite);
+    renderer->draw(sprite);
 }
 
-void SpriteSheet::draw(sf::RenderWindow* wnd, int spriteIndex, const Rect& _draw_area, RepeatMode mode) {
-    auto sprite = m_sprites[spriteIndex];
-    sprite.setPosition(m_position + m_torigin);
+void SpriteSheet::draw(Renderer* renderer, int spriteIndex, const Rect& _draw_area, RepeatMode mode) {
+    const auto& sprite = m_sprites[spriteIndex];
 
     const sf::Rect<int> draw_area({ (int)_draw_area.left(), (int)_draw_area.top()},
                                   { (int)_draw_area.width(), (int)_draw_area.height()});
 
-    if (!draw_area.size.x || !draw_area.size.y) {
+    if (draw_area.size.x <= 0 || draw_area.size.y <= 0) {
         return;
     }
 
-    Vector size = { (float)abs(sprite.getTextureRect().size.x), (float)abs(sprite.getTextureRect().size.y) };
-
-    int c_w = draw_area.size.x / size.x;
-    int c_h = draw_area.size.y / size.y;
-
-    int rem_w = draw_area.size.x % (int)size.x;
-    int rem_h = draw_area.size.y % (int)size.y;
-
-    for (int y = 0; y < c_h; ++y) {
-        for (int x = 0; x < c_w; ++x) {
-            sprite.setPosition({x * size.x + draw_area.position.x, y * size.y + draw_area.position.y});
-            wnd->draw(sprite);
-        }
-    }
-
-    if (rem_h) {
-        auto new_rect = sprite.getTextureRect();
-        auto old_height = new_rect.size.y;
-        new_rect.size.y = rem_h;
-        sprite.setTextureRect(new_rect);
-
-        for (int x = 0; x < c_w; ++x) {
-            sprite.setPosition({x * size.x + draw_area.position.x, c_h * size.y + draw_area.position.y});
-            wnd->draw(sprite);
-        }
-
-        new_rect.size.y = old_height;
-        sprite.setTextureRect(new_rect);
-    }
-
-    if (rem_w) {
-        auto new_rect = sprite.getTextureRect();
-        new_rect.size.x = rem_w;
-        sprite.setTextureRect(new_rect);
-
-        for (int y = 0; y < c_h; ++y) {
-            sprite.setPosition({c_w * size.x + draw_area.position.x, y * size.y + draw_area.position.y});
-            wnd->draw(sprite);
-        }
-    }
+    // one quad, the cell is repeated by the texture sampler
+    const sf::FloatRect area(sf::Vector2f(draw_area.position) - sprite.getOrigin(), sf::Vector2f(draw_area.size));
+    renderer->drawRepeated(sprite.getTexture(), sprite.getTextureRect(), area, sprite.getColor());
 }
 
-void SpriteSheet::draw(sf::RenderWindow* wnd) {
+void SpriteSheet::draw(Renderer* renderer, const sf::RenderStates& states) {
     m_current_sprite->setPosition(m_position);
-    wnd->draw(*m_current_sprite);
+    renderer->draw(*m_current_sprite, states);
 }
 
 void SpriteSheet::setPosition(const Vector& pos) {
@@ -407,50 +640,58 @@ void SpriteSheet::flipX(bool value) {
 Pallete::Pallete() {
 }
 
+std::map<Pallete::CacheKey, std::vector<Pallete::Variant>> Pallete::s_textures;
+
 void Pallete::create(const std::initializer_list<sf::Color>& original_colors, const std::initializer_list<sf::Color>& swaped_colors) {
     assert(original_colors.size() == swaped_colors.size());
-    int arr_size = original_colors.size();
-    const std::string frag_shader =
-            "#version 120\n"\
-            "const int arr_size = " + utils::toString(arr_size) + ";"\
-            "uniform vec3 color1[arr_size];"\
-            "uniform vec3 color2[arr_size];"\
-            "uniform sampler2D texture;"\
-            "void main()"\
-            "{"\
-            "   vec4 myindex = texture2D(texture, gl_TexCoord[0].xy);"\
-            "   vec3 index = vec3(myindex.r,myindex.g,myindex.b);"\
-            "   gl_FragColor = myindex;"\
-            "   for (int i=0; i < arr_size; ++i)"\
-            "       if (index == color1[i]) {"\
-            "           gl_FragColor = vec4(color2[i].r,color2[i].g,color2[i].b,myindex.a);"\
-            "           break; }"\
-            "}";
-
-    m_shader.loadFromMemory(frag_shader, sf::Shader::Type::Fragment);
 
-    std::vector<sf::Glsl::Vec3> colors1(arr_size);
-    std::vector<sf::Glsl::Vec3> colors2(arr_size);
+    m_original_colors.clear();
+    m_swaped_colors.clear();
+    m_id = 14695981039346656037ull; // FNV-1a over both color lists
 
-    for (int i = 0; i < arr_size; ++i) {
-        auto& original_color = original_colors.begin()[i];
-        auto& swaped_color = swaped_colors.begin()[i];
+    auto add = [this](std::vector<uint32_t>& colors, const sf::Color& color) {
+        colors.push_back(packColor(color.r, color.g, color.b, 0));
+        m_id = (m_id ^ color.toInteger()) * 1099511628211ull;
+    };
 
-        colors1[i] = sf::Glsl::Vec3(original_color.r , original_color.g, original_color.b) / 255.f;
-        colors2[i] = sf::Glsl::Vec3(swaped_color.r, swaped_color.g, swaped_color.b) / 255.f;
+    for (auto& color : original_colors) {
+        add(m_original_colors, color);
     }
 
-    m_shader.setUniformArray("color1", colors1.data(), arr_size);
-    m_shader.setUniformArray("color2", colors2.data(), arr_size);
-    m_shader.setUniform("texture", sf::Shader::CurrentTexture);
+    for (auto& color : swaped_colors) {
+        add(m_swaped_colors, color);
+    }
 }
 
-void Pallete::apply() {
-    sf::Shader::bind(&m_shader);
+uint64_t Pallete::id() const {
+    return m_id;
 }
 
-void Pallete::cancel() {
-    sf::Shader::bind(nullptr);
+const sf::Texture& Pallete::getTexture(const sf::Texture& source) const {
+    auto& variants = s_textures[CacheKey(m_id, &source)];
+    for (const auto& variant : variants) {
+        if (variant.original_colors == m_original_colors && variant.swaped_colors == m_swaped_colors) {
+            return *variant.texture;
+        }
+    }
+
+    const sf::Image image = source.copyToImage();
+    const size_t count = image.getSize().x * image.getSize().y;
+
+    std::vector<uint32_t> pixels(count);
+    std::memcpy(pixels.data(), image.getPixelsPtr(), count * sizeof(uint32_t));
+    remapPixels(pixels.data(), count, m_original_colors.data(), m_swaped_colors.data(), m_original_colors.size());
+
+    auto texture = std::make_unique<sf::Texture>();
+    if (!texture->resize(image.getSize())) {
+        LOG("Pallete", ERROR, "Failed to create palette texture");
+        return source;
+    }
+    texture->update(reinterpret_cast<const uint8_t*>(pixels.data()));
+    texture->setSmooth(source.isSmooth());
+
+    variants.push_back({ m_original_colors, m_swaped_colors, std::move(texture) });
+    return *variants.back().texture;
 }
 //---------------------------------------------------------------------------
 //! Animator
@@ -472,6 +713,7 @@ void Animator::create(const std::string& name, const sf::Texture& texture, const
 
     if (!m_current_animation) {
         m_current_animation = animation;
+        resolvePalleteTexture();
     }
 }
 
@@ -487,6 +729,7 @@ void Animator::create(const std::string& name, const sf::Texture& texture, const
 
     if (!m_current_animation) {
         m_current_animation = animation;
+        resolvePalleteTexture();
     }
 }
 
@@ -514,6 +757,7 @@ void Animator::create(const std::string& name, const sf::Texture& texture, const
  
     if (!m_current_animation) {
         m_current_animation = animation;
+        resolvePalleteTexture();
     }
 }
 
@@ -523,6 +767,7 @@ void Animator::play(const std::string& name) {
         assert(m_current_animation); //not exist
         last_anim_name = name;
         m_current_animation->reset();
+        resolvePalleteTexture();
     }
 }
 
@@ -532,23 +777,33 @@ void Animator::update(int delta_time) {
     }
 }
 
-void Animator::draw(sf::RenderWindow* wnd) {
+void Animator::draw(Renderer* renderer) {
     if (isVisible()) {
-        if (m_pallete) {
-            m_pallete->apply();
-        }
+        sf::RenderStates states;
+        states.texture = m_pallete_texture;
 
         m_current_animation->setPosition(getPosition());
-        m_current_animation->draw(wnd);
-
-        if (m_pallete) {
-            m_pallete->cancel();
-        }
+        m_current_animation->draw(renderer, states);
     }
 }
 
 void Animator::setPallete(Pallete* pallete) {
     m_pallete = pallete;
+
+    // build swapped textures now rather than on first draw
+    if (m_pallete) {
+        for (auto& animation : m_animations) {
+            if (auto texture = animation.second->getTexture()) {
+                m_pallete->getTexture(*texture);
+            }
+        }
+    }
+    resolvePalleteTexture();
+}
+
+void Animator::resolvePalleteTexture() {
+    const sf::Texture* texture = m_current_animation ? m_current_animation->getTexture() : nullptr;
+    m_pallete_texture = (m_pallete && texture) ? &m_pallete->getTexture(*texture) : nullptr;
 }
 
 void Animator::flipX(bool value) {
@@ -595,107 +850,51 @@ void Animator::setOrigin(const std::string& animName, const Vector& diff) {
 //---------------------------------------------------------------------------
 //! MusicManager
 //---------------------------------------------------------------------------
-void MusicManager::play(const std::string& name) {
+void MusicManager::play(const std::string& name, int crossfade_ms) {
+    if (name.empty() && m_current) {
+        m_engine.resume();
+        return;
+    }
+
     if (!name.empty()) {
         m_current_music = name;
     }
 
-    auto it = m_resources.find(m_current_music);
-
-    if (it != m_resources.end()) {
-        it->second->play();
-    } else {
+    Handle track = acquire(m_current_music);
+    if (!track) {
         LOG("MusicManager", ERROR, "music not found: " + m_current_music);
+        return;
     }
+
+    m_engine.play(*track, crossfade_ms);
+    m_fading = m_engine.isFading() ? std::move(m_current) : Handle();
+    m_current = std::move(track);
 }
 
 void MusicManager::stop() {
-    for (auto& music : m_resources) {
-        music.second->stop();
-    }
+    m_engine.stop();
+    m_current = Handle();
+    m_fading = Handle();
     m_current_music.clear();
 }
 
 void MusicManager::pause() {
-    for (auto& music : m_resources) {
-        music.second->pause();
-    }
+    m_engine.pause();
 }
 
 void MusicManager::setPitch(float value) {
-    for (auto music : m_resources) {
-        music.second->setPitch(value);
-    }
-}
-//---------------------------------------------------------------------------
-//! FlowText
-//---------------------------------------------------------------------------
-FlowText::FlowText(const sf::Font& font, bool self_remove) 
-    : m_text(font, "")
-{
-    m_text.setFillColor(sf::Color::Black);
-    m_text.setCharacterSize(20);
-    m_text.setStyle(sf::Text::Bold);
-    m_flashing = false;
-    m_self_remove = self_remove;
-}
-
-FlowText* FlowText::clone() const {
-    const sf::Font& font = m_text.getFont();
-    auto flow_text = new FlowText(font);
-    flow_text->m_text =  m_text;
-    flow_text->m_splash_vector = m_splash_vector;
-    return flow_text;
-}
-
-bool FlowText::isFlashing() const {
-    return m_flashing;
-}
-
-void FlowText::splash(const Vector& pos, const std::string& text) {
-    m_flashing = true;
-    setPosition(pos);
-    m_text.setString(text);
-    m_offset.x = m_offset.y = 0;
-    m_time = 0;
+    m_engine.setPitch(value);
 }
 
-void FlowText::setSplashVector(const Vector& vector) {
-    m_splash_vector = vector;
-}
-
-void FlowText::update(int delta_time) {
-    if (m_flashing) {
-        m_time += delta_time;
-        m_offset.x = m_time*0.03f*m_splash_vector.x;
-        m_offset.y = m_time*0.03f*m_splash_vector.y;
-
-        m_offset.x *= 2;
-        m_color = (int)m_time*0.2f;
-        if (m_color >= 255)
-            m_flashing = false;
-
-        const sf::Color& color = m_text.getFillColor();
-
-        m_text.setFillColor(sf::Color(color.r, color.g, color.b, 255 - m_color));
-    } else if (m_self_remove) {
-        removeLater();
+void MusicManager::update(int delta_time) {
+    m_engine.update(delta_time);
+    if (m_fading && !m_engine.isFading()) {
+        m_fading = Handle();
     }
 }
 
-void FlowText::draw(sf::RenderWindow* window) {
-    if (m_flashing) {
-        m_text.setPosition(getPosition() + m_offset);
-        window->draw(m_text);
-    }
-}
-
-void FlowText::setTextColor(const sf::Color& color) {
-    m_text.setFillColor(color);
-}
-
-void FlowText::setTextSize(int size) {
-    m_text.setCharacterSize(size);
+void MusicManager::logStats() const {
+    m_engine.logStats();
 }
 //---------------------------------------------------------------------------
 //! Label
@@ -734,26 +933,22 @@ void Label::setSprite(const sf::Sprite& sprite) {
 }
 
 void Label::setFontColor(const sf::Color& color) {
-    if (m_text) {
-        m_text->setFillColor(color);
-    }
+    m_text.setFillColor(color);
 }
 
 void Label::setFontSize(int size) {
-    m_text->setCharacterSize(size);
+    m_font_size = size;
+    m_font_dirty = true;
 }
 
 void Label::setFontName(const sf::Font& font) {
-    if (!m_text) {
-        m_text = std::make_unique<sf::Text>(font, "");
-        return;
-    }
-
-    m_text->setFont(font);
+    m_font = &font;
+    m_font_dirty = true;
 }
 
 void Label::setFontStyle(uint32_t style) {
-    m_text->setStyle(style);
+    m_font_style = style;
+    m_font_dirty = true;
 }
 
 void Label::setTextAlign(int value) {
@@ -761,7 +956,7 @@ void Label::setTextAlign(int value) {
 }
 
 void Label::setString(const std::string& str) {
-    m_text->setString(str);
+    m_text.setString(str);
 }
 
 void Label::setOutlineColor(const sf::Color& color) {
@@ -780,24 +975,36 @@ bool Label::contains(const Vector& point) const {
     return m_rect.isContain(point);
 }
 
-void Label::draw(sf::RenderWindow* window) {
-    window->draw(m_shape);
+void Label::draw(Renderer* renderer) {
+    drawBackground(renderer);
 
-    if (m_sprite) {
-        m_sprite->setPosition(getPosition());
-        window->draw(*m_sprite);
-    }
+    const BitmapText* text = getText();
 
-    if (m_text && !m_text->getString().isEmpty()) {
+    if (text && !m_text.getString().empty()) {
         if (m_text_align == center) {
-            Vector textBounds(m_text->getGlobalBounds().size.x, m_text->getGlobalBounds().size.y);
-            m_text->setPosition(getPosition() + m_rect.size() / 2 - textBounds / 2);
+            Vector textBounds(m_text.getGlobalBounds().size.x, m_text.getGlobalBounds().size.y);
+            m_text.setPosition(getPosition() + m_rect.size() / 2 - textBounds / 2);
         } else if (m_text_align == left) {
-            m_text->setPosition({getPosition().x, getPosition().y});
+            m_text.setPosition({getPosition().x, getPosition().y});
         }
 
-        window->draw(*m_text);
+        m_text.draw(renderer);
+    }
+}
+
+void Label::drawBackground(Renderer* renderer) {
+    if (m_shape.getOutlineThickness()) {
+        renderer->draw(m_shape);
+    } else if (m_shape.getFillColor().a) { // plain background batches as untextured quad
+        sf::RenderStates states(m_shape.getTransform());
+        renderer->drawQuad(sf::FloatRect({ 0.f, 0.f }, m_shape.getSize()), sf::FloatRect(), m_shape.getFillColor(), states);
+    }
+
+    if (m_sprite) {
+        m_sprite->setPosition(getPosition());
+        renderer->draw(*m_sprite);
     }
+
 }
 
 void Label::onPropertySet(const std::string& name) {
@@ -807,6 +1014,14 @@ void Label::onPropertySet(const std::string& name) {
     }
 }
 
+void Label::onPropertyTemplateSet() {
+    GameObject::onPropertyTemplateSet();
+    const Property text = getProperty("text");
+    if (text.isValid()) {
+        setString(text.asString());
+    }
+}
+
 void Label::onStarted() {
     if (getProperty("x").isValid()) {
         setBounds(
@@ -825,6 +1040,19 @@ Rect Label::getBounds() const {
     return m_rect;
 }
 
+const BitmapText* Label::getText() {
+    if (!m_font) {
+        return nullptr;
+    }
+
+    if (m_font_dirty) {
+        m_text.setFont(&BitmapFont::get(*m_font, m_font_size, m_font_style));
+        m_font_dirty = false;
+    }
+
+    return &m_text;
+}
+
 sf::Sprite& Label::getSprite() {
     return *m_sprite;
 }
@@ -832,8 +1060,11 @@ sf::Sprite& Label::getSprite() {
 Label* Label::clone() const {
     Label* new_label = new Label();
 
-    if (m_text)
-        new_label->m_text = std::make_unique<sf::Text>(*m_text);
+    new_label->m_font = m_font;
+    new_label->m_font_size = m_font_size;
+    new_label->m_font_style = m_font_style;
+    new_label->m_font_dirty = m_font_dirty;
+    new_label->m_text = m_text;
  
     if (m_sprite)
         new_label->m_sprite = std::make_unique<sf::Sprite>(*m_sprite);
@@ -846,3 +1077,178 @@ Label* Label::clone() const {
 
     return new_label;
 }
+//---------------------------------------------------------------------------
+//! NumberLabel
+//---------------------------------------------------------------------------
+NumberLabel::NumberLabel(const std::string& prefix, int digits)
+    : m_prefix(prefix)
+    , m_min_digits(digits)
+    , m_digits(digits, 0) {
+    setName("NumberLabel");
+}
+
+void NumberLabel::setValue(int value) {
+    // counters are never negative, there are only digit glyphs
+    value = std::max(value, 0);
+
+    if (value == m_value) {
+        return;
+    }
+
+    m_value = value;
+
+    // the digits count is the minimum width, as with std::setw
+    size_t count = 1;
+    for (int rest = value / 10; rest; rest /= 10) {
+        ++count;
+    }
+    count = std::max(count, m_min_digits);
+
+    if (count != m_digits.size()) {
+        m_digits.assign(count, NO_DIGIT);
+        if (m_font) {
+            m_vertices.resize(count * 6);
+        }
+    }
+
+    for (int i = static_cast<int>(m_digits.size()) - 1; i >= 0; --i) {
+        const int digit = value % 10;
+        value /= 10;
+
+        if (m_digits[i] != digit) {
+            setDigit(i, digit);
+        }
+    }
+}
+
+int NumberLabel::getValue() const {
+    return m_value;
+}
+
+void NumberLabel::setDigit(int index, int digit) {
+    m_digits[index] = digit;
+
+    if (!m_font) { // quads are built on the first draw
+        return;
+    }
+
+    // glyph centered in a fixed cell, so the number doesn't jitter while counting
+    const BitmapFont::Glyph& glyph = m_font->getGlyph(U'0' + digit);
+    const sf::Vector2f pen(m_digits_left + index * m_cell_width + (m_cell_width - glyph.advance) / 2.f,
+                           static_cast<float>(m_font->getCharacterSize()));
+    const sf::Vector2f lt = pen + glyph.bounds.position;
+    const sf::Vector2f rb = lt + glyph.bounds.size;
+    const sf::Vector2f uv0(glyph.texture_rect.position);
+    const sf::Vector2f uv1(glyph.texture_rect.position + glyph.texture_rect.size);
+
+    sf::Vertex* quad = &m_vertices[index * 6];
+    quad[0] = { lt,             m_color, uv0 };
+    quad[1] = { { rb.x, lt.y }, m_color, { uv1.x, uv0.y } };
+    quad[2] = { { lt.x, rb.y }, m_color, { uv0.x, uv1.y } };
+    quad[3] = quad[2];
+    quad[4] = quad[1];
+    quad[5] = { rb,             m_color, uv1 };
+}
+
+void NumberLabel::layout(const BitmapText& text) {
+    m_font = text.getFont();
+    m_color = text.getFillColor();
+
+    m_prefix_text = BitmapText(*m_font, m_prefix);
+    m_prefix_text.setFillColor(m_color);
+    m_digits_left = m_prefix_text.findCharacterPos(m_prefix.size()).x;
+
+    m_cell_width = 0.f;
+    for (char32_t code = U'0'; code <= U'9'; ++code) {
+        m_cell_width = std::max(m_cell_width, m_font->getGlyph(code).advance);
+    }
+
+    m_vertices.resize(m_digits.size() * 6);
+    for (size_t i = 0; i < m_digits.size(); ++i) {
+        setDigit(i, m_digits[i]);
+    }
+}
+
+void NumberLabel::draw(Renderer* renderer) {
+    drawBackground(renderer);
+
+    const BitmapText* text = getText();
+    if (!text || !text->getFont()) {
+        return;
+    }
+
+    if (text->getFont() != m_font || text->getFillColor() != m_color) {
+        layout(*text);
+    }
+
+    sf::RenderStates states(&m_font->getTexture());
+    states.transform.translate(getPosition());
+    m_prefix_text.draw(renderer, states);
+    renderer->drawTriangles(m_vertices.data(), m_vertices.size(), states);
+}
+//---------------------------------------------------------------------------
+//! CachedLayer
+//---------------------------------------------------------------------------
+CachedLayer::CachedLayer(const Vector& size)
+    : m_size(size) {
+    setName("CachedLayer");
+}
+
+void CachedLayer::invalidate() {
+    m_dirty = true;
+}
+
+void CachedLayer::setCacheEnabled(bool enabled) {
+    m_cache_enabled = enabled;
+    m_dirty = true;
+}
+
+bool CachedLayer::isCacheEnabled() const {
+    return m_cache_enabled;
+}
+
+bool CachedLayer::createCache() {
+    auto cache = std::make_unique<sf::RenderTexture>();
+    if (!cache->resize({ static_cast<unsigned>(m_size.x), static_cast<unsigned>(m_size.y) })) {
+        LOG("CachedLayer", ERROR, "Failed to create cache texture, drawing directly");
+        m_cache_enabled = false;
+        return false;
+    }
+
+    m_cache = std::move(cache);
+    m_cache_renderer.setTarget(m_cache.get());
+    return true;
+}
+
+void CachedLayer::draw(Renderer* renderer) {
+    if (!isVisible()) {
+        return;
+    }
+
+    // the cache is a GPU render texture, other backends get children directly
+    const bool cacheable = m_cache_enabled && renderer->getTarget();
+
+    if (!cacheable || (!m_cache && !createCache())) {
+        sf::View view = renderer->getView();
+        sf::View shifted = view;
+        shifted.move(-sf::Vector2f(getPosition().x, getPosition().y));
+        renderer->setView(shifted);
+        GameObject::draw(renderer);
+        renderer->setView(view);
+        return;
+    }
+
+    if (m_dirty) {
+        m_cache->clear(sf::Color::Transparent);
+        GameObject::draw(&m_cache_renderer);
+        m_cache_renderer.flush();
+        m_cache->display();
+        m_dirty = false;
+    }
+
+    // cache holds alpha-blended, so premultiplied colors
+    sf::RenderStates states(sf::BlendMode(sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha));
+    sf::Sprite sprite(m_cache->getTexture());
+    sprite.setPosition(getPosition());
+    renderer->draw(sprite, states);
+}
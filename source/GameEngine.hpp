@@ -2,19 +2,28 @@
 #define GAME_ENGINE_HPP
 
 #include <assert.h>
+#include <map>
 #include <memory>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 
+#include <BitmapFont.hpp>
 #include <Collisions.hpp>
+#include <FrameCapture.hpp>
 #include <InputManager.hpp>
+#include <MusicEngine.hpp>
 #include <GameObject.hpp>
 #include <Rect.hpp>
+#include <Renderer.hpp>
+#include <ResolutionGovernor.hpp>
+#include <SoftwareRenderBackend.hpp>
+#include <TextureAtlas.hpp>
 #include <ResourceManager.hpp>
 #include <RTIIX.hpp>
 #include <TimerManager.hpp>
 #include <Vector.hpp>
+#include <VoiceManager.hpp>
 #include "TileMap.hpp"
 
 #include <iostream>
@@ -48,27 +57,31 @@ using SoundManager = ResourceManager<sf::SoundBuffer>;
 
 
 template <>
-inline bool ResourceManager<sf::Music>::loadFromFile(const std::string& name, const std::string& file_path) {
-    assert(m_resources[name] == nullptr); // allready exist
-    m_resources[name] = new sf::Music();
-    if (!m_resources[name]->openFromFile(file_path)) {
-        std::cerr << "can't load resource from file: " << file_path << std::endl;
-        return false;
-    }
-    m_resources[name]->setLooping(true);
-    return true;
+inline size_t ResourceManager<sf::Texture>::residentSize(const sf::Texture& texture) {
+    return size_t(texture.getSize().x) * texture.getSize().y * 4;
+}
+
+template <>
+inline size_t ResourceManager<sf::SoundBuffer>::residentSize(const sf::SoundBuffer& buffer) {
+    return static_cast<size_t>(buffer.getSampleCount()) * sizeof(std::int16_t);
 }
 
+template <>
+inline size_t ResourceManager<MusicTrack>::residentSize(const MusicTrack& track) {
+    return track.intro().size() * sizeof(std::int16_t);
+}
+
+// fonts are read from their source while used, they are loaded once and never evicted
+
 template <>
 inline bool ResourceManager<sf::Font>::loadFromFile(const std::string& name, const std::string& file_path) {
-    auto it = m_resources.find(name);
-    if (it != m_resources.end())
+    if (contains(name))
     {
         LOG("RES_MNG", ERROR, "Resource with name %s already exists", name.c_str());
         return false;
     }
 
-    auto resource = new sf::Font();
+    auto resource = std::make_unique<sf::Font>();
     if (!resource->openFromFile(file_path))
     {
         LOG("RES_MNG", ERROR, "Failed to load %s", name.c_str());
@@ -77,18 +90,50 @@ inline bool ResourceManager<sf::Font>::loadFromFile(const std::string& name, con
 
     LOG("RES_MNG", DEBUG, "Loaded resource '%s' from file %s", name.c_str(), file_path.c_str());
 
-    m_resources[name] = resource;
-    return true;
+    return insert(name, std::move(resource), nullptr);
 }
 
-class MusicManager : public ResourceManager<sf::Music> {
+template <>
+inline bool ResourceManager<sf::Font>::loadFromPack(const std::string& name, const AssetPack& pack, const std::string& entry) {
+    if (contains(name)) {
+        LOG("RES_MNG", ERROR, "Resource with name %s already exists", name.c_str());
+        return false;
+    }
+
+    // sf::Font reads glyphs from this memory on demand, it isn't copied
+    const std::span<const uint8_t> data = pack.find(entry);
+    auto resource = std::make_unique<sf::Font>();
+    if (data.empty() || !resource->openFromMemory(data.data(), data.size())) {
+        LOG("RES_MNG", ERROR, "Failed to load %s", name.c_str());
+        return false;
+    }
+
+    LOG("RES_MNG", DEBUG, "Loaded resource '%s' from pack entry %s", name.c_str(), entry.c_str());
+    return insert(name, std::move(resource), nullptr);
+}
+
+/*
+ * @class MusicManager
+ * @brief Music tracks played through one MusicEngine, tracks in play are held by handles
+ */
+class MusicManager : public ResourceManager<MusicTrack> {
 public:
-    void play(const std::string& name = "");
+    /*
+     * @brief Play track from the beginning
+     * @param name [in] - track name, empty - resume the current one
+     * @param crossfade_ms [in] - fade the playing track out meanwhile, 0 - cut it
+     */
+    void play(const std::string& name = "", int crossfade_ms = 0);
     void stop();
     void pause();
     void setPitch(float value);
+    void update(int delta_time);
+    void logStats() const;
 
 private:
+    MusicEngine m_engine;
+    Handle m_current;
+    Handle m_fading;
     std::string m_current_music;
 };
 
@@ -97,15 +142,68 @@ public:
     Game(const std::string& name, const Vector& screen_size);
     virtual ~Game() = default;
     void run();
+
+    /*
+     * @brief Run without window and graphics output, draws go to recording backend
+     * @param frames [in] - number of fixed 60 Hz frames to simulate
+     * @param capture_path [in] - if set, frames are rasterised on CPU and the last one is saved here,
+     *                             a pattern with '%' (e.g. "frame_%05d.png") captures a sequence instead
+     * @param every_nth [in] - sequence capture interval
+     * @note Logs average and peak per-frame render statistics at the end
+     */
+    void runHeadless(int frames, const std::string& capture_path = "", unsigned every_nth = 1);
+
+    /*
+     * @brief Render with CPU rasterizer and present the result as one textured quad
+     * @param enabled [in] - software rendering on/off, must be set before run()
+     * @param downscale [in] - framebuffer is screen size divided by this factor
+     * @param threads [in] - rasteriser bands, 0 - hardware concurrency
+     */
+    void setSoftwareRendering(bool enabled, float downscale = 1.f, unsigned threads = 0);
+
+    /*
+     * @brief Write every Nth presented frame to a PNG sequence, encoded off the main thread
+     * @param path_pattern [in] - printf pattern with frame number, empty - capture off
+     * @param every_nth [in] - capture one frame of every N
+     */
+    void setFrameCapture(const std::string& path_pattern, unsigned every_nth = 1);
+    FrameCapture* frameCapture();
+
+    /*
+     * @brief Render statistics of the last drawn frame
+     */
+    const RenderStats& renderStats() const;
+
+    /*
+     * @brief Picks the scene render scale from measured frame times, fed by run()
+     */
+    ResolutionGovernor& resolutionGovernor();
+
+    /*
+     * @brief Pack sprite textures into atlas pages, batched draws from them are remapped by the renderer
+     * @param names [in] - texture manager names
+     */
+    void buildTextureAtlas(const std::vector<std::string>& names);
+    const TextureAtlas& textureAtlas() const;
     GameObject* getRootObject();
+    /*
+     * @brief Resources packed by asset-packer, not open if the game runs from loose files
+     */
+    AssetPack& assetPack();
     TextureManager& textureManager();
     FontManager& fontManager();
     SoundManager& soundManager();
     EventManager& eventManager();
     InputManager& inputManager();
     MusicManager& musicManager();
+    VoiceManager& voiceManager();
+
+    /*
+     * @brief Log resident bytes and load/eviction counters of every resource type
+     */
+    void logResourceStats() const;
     void playSound(const std::string& name);
-    void playMusic(const std::string& name);
+    void playMusic(const std::string& name, int crossfade_ms = 0);
     void stopMusic();
     Vector screenSize() const;
 
@@ -116,20 +214,34 @@ protected:
 
 private:
     GameObject* m_root_object = nullptr;
+    AssetPack m_asset_pack;             //!< declared before managers, resources stream from it
     TextureManager m_texture_manager;
     FontManager m_font_manager;
     SoundManager m_sound_manager;
     MusicManager m_music_manager;
     EventManager m_event_manager;
     InputManager m_input_manager;
-    std::vector<std::unique_ptr<sf::Sound>> m_activeSounds;
-    int m_activeSoundSlot = 0;
+    VoiceManager m_voice_manager;
 
     std::unique_ptr<sf::RenderWindow> m_window;
+    Renderer m_renderer;
+    TextureAtlas m_texture_atlas;
+    RenderStats m_render_stats;
+    RenderStats m_run_stats;           //!< sum over frames presented by run()
+    size_t m_run_frames = 0;
+    ResolutionGovernor m_resolution_governor;
+    std::unique_ptr<SoftwareRenderBackend> m_software_backend;
+    std::unique_ptr<sf::Texture> m_software_frame;
+    std::unique_ptr<FrameCapture> m_frame_capture;
 
     Vector m_screen_size;
     sf::Color m_clear_color = sf::Color::Black;
-    void draw(sf::RenderWindow* render_window);
+    void draw(Renderer* renderer);
+    void drawFrame();
+    void presentSoftwareFrame();
+    void logResolutionStats() const;
+    void logRenderStats() const;
+    void captureFrame();
     void updateStats(const sf::Time time);
     sf::Time m_min_time = sf::seconds(3600);
     sf::Time m_max_time = sf::Time::Zero;
@@ -163,12 +275,13 @@ public:
     void scale(float fX, float fY);
     void flipX(bool isFliped);
     bool empty() const;
+    const sf::Texture* getTexture() const;
     void setOrigin(const Vector& vector);
     void setOrigin(const Vector& pos, int spriteId);
 
-    void draw(sf::RenderWindow* wnd);
-    void draw(sf::RenderWindow* wnd, int spriteIndex);
-    void draw(sf::RenderWindow* wnd, int spriteIndex, const Rect& draw_area, RepeatMode mode = RepeatMode::CLAMP);
+    void draw(Renderer* renderer, const sf::RenderStates& states = sf::RenderStates::Default);
+    void draw(Renderer* renderer, int spriteIndex);
+    void draw(Renderer* renderer, int spriteIndex, const Rect& draw_area, RepeatMode mode = RepeatMode::CLAMP);
     void update(int delta_time);
     void setSpriteIndex(int index);
 
@@ -190,12 +303,28 @@ public:
     Pallete();
     void create(const std::initializer_list<sf::Color>& original_colors,
                 const std::initializer_list<sf::Color>& swaped_colors);
-    void apply();
-    void cancel();
+
+    /*
+     * @brief Get palette swapped variant of the texture, variants are built on CPU
+     *        once and shared by all palettes with the same colors
+     * @note Searches the shared cache, resolve when the palette is applied rather than per draw
+     */
+    const sf::Texture& getTexture(const sf::Texture& source) const;
+    uint64_t id() const;
 
 private:
-    sf::Shader m_shader;
-    int m_old_shader = 0;
+    struct Variant {
+        std::vector<uint32_t> original_colors;
+        std::vector<uint32_t> swaped_colors;
+        std::unique_ptr<sf::Texture> texture;
+    };
+
+    using CacheKey = std::pair<uint64_t, const sf::Texture*>;
+    static std::map<CacheKey, std::vector<Variant>> s_textures;  //!< colors compared, the id is only a hash
+
+    std::vector<uint32_t> m_original_colors; //!< packed rgb, alpha masked
+    std::vector<uint32_t> m_swaped_colors;
+    uint64_t m_id = 0;
 };
 
 class Animator : public GameObject {
@@ -207,7 +336,7 @@ public:
     void create(const std::string& name, const sf::Texture& texture, const std::vector<Rect>& rects, float speed);
     void play(const std::string& name);
     void update(int delta_time) override;
-    void draw(sf::RenderWindow* wnd) override;
+    void draw(Renderer* renderer) override;
     void flipX(bool value);
     void setColor(const sf::Color& color);
     void setSpeed(const std::string& animation, float speed);
@@ -217,35 +346,16 @@ public:
     void setOrigin(const std::string& animName, const Vector& diff);
 
 private:
+    void resolvePalleteTexture();
+
     Pallete* m_pallete = nullptr;
+    const sf::Texture* m_pallete_texture = nullptr;  //!< swapped texture of the current animation
     std::unordered_map<std::string, SpriteSheet*> m_animations;
     SpriteSheet* m_current_animation = nullptr;
     std::string last_anim_name;
     bool m_flipped = false;
 };
 
-class FlowText : public GameObject {
-public:
-    FlowText(const sf::Font& font, bool self_remove = false);
-    void setTextColor(const sf::Color& color);
-    void setTextSize(int size);
-    void splash(const Vector& pos, const std::string& text);
-    void update(int delta_time) override;
-    void draw(sf::RenderWindow* window) override;
-    bool isFlashing() const;
-    void setSplashVector(const Vector& vector);
-    FlowText* clone() const;
-
-private:
-    bool m_self_remove = false;
-    sf::Text m_text;
-    Vector m_offset;
-    Vector m_splash_vector = {1,-1};
-    float m_time;
-    int m_color;
-    bool m_flashing;
-};
-
 class Label : public GameObject {
 public:
     enum { left, center };
@@ -266,19 +376,83 @@ public:
     bool contains(const Vector& point) const;
     Label* clone() const;
     sf::Sprite& getSprite();
-    void draw(sf::RenderWindow* window) override;
+    void draw(Renderer* renderer) override;
 
 protected:
     void onPropertySet(const std::string& name) override;
+    void onPropertyTemplateSet() override;
     void onStarted() override;
+    void drawBackground(Renderer* renderer);
+    const BitmapText* getText();
     sf::RectangleShape m_shape;
 
 private:
     void init();
     int m_text_align = center;
     std::unique_ptr<sf::Sprite> m_sprite;
-    std::unique_ptr<sf::Text> m_text;
+    const sf::Font* m_font = nullptr;
+    unsigned m_font_size = 30;
+    uint32_t m_font_style = sf::Text::Regular;
+    bool m_font_dirty = false;  //!< baked font is resolved on use, after all font settings
+    BitmapText m_text;
     Rect m_rect;
 };
 
+/// @brief Left aligned label with a static prefix and a zero padded number.
+///
+/// Font, size and color are the label's ones (Label::setFontName etc.), the
+/// prefix and the digits are drawn from its BitmapFont page in one batch.
+/// Digits are laid out in fixed cells as ready quads of label's baked font,
+/// setValue() only swaps glyphs of the digits which changed, no text layout
+/// or allocations. Like std::setw, the width is a minimum: a longer number
+/// gets more cells instead of being cut.
+class NumberLabel : public Label {
+public:
+    NumberLabel(const std::string& prefix, int digits);
+    void setValue(int value);
+    int getValue() const;
+    void draw(Renderer* renderer) override;
+
+private:
+    void layout(const BitmapText& text);
+    void setDigit(int index, int digit);
+
+    static constexpr uint8_t NO_DIGIT = 0xFF;
+
+    std::string m_prefix;
+    size_t m_min_digits = 0;
+    int m_value = -1;
+    std::vector<uint8_t> m_digits;
+    BitmapText m_prefix_text;
+    std::vector<sf::Vertex> m_vertices;  //!< one quad per digit
+    const BitmapFont* m_font = nullptr;  //!< font the quads are laid out with
+    sf::Color m_color;
+    float m_digits_left = 0.f;
+    float m_cell_width = 0.f;
+};
+
+/// @brief Group of rarely changing objects rendered through a cached texture.
+///
+/// Children are drawn into an offscreen texture of the given size only after
+/// invalidate(), otherwise the cached texture is drawn as a single quad.
+/// Children positions are in the texture space, the layer is drawn at its own
+/// position. Falls back to direct drawing if the texture can't be created.
+class CachedLayer : public GameObject {
+public:
+    CachedLayer(const Vector& size);
+    void invalidate();
+    void setCacheEnabled(bool enabled);
+    bool isCacheEnabled() const;
+    void draw(Renderer* renderer) override;
+
+private:
+    bool createCache();
+
+    Vector m_size;
+    bool m_cache_enabled = true;
+    bool m_dirty = true;
+    std::unique_ptr<sf::RenderTexture> m_cache;
+    Renderer m_cache_renderer;
+};
+
 #endif // GAME_ENGINE_HPP
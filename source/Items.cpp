@@ -37,10 +37,10 @@ MoveablePlatform::MoveablePlatform()
     m_amplitude = 0;
 }
 
-void MoveablePlatform::draw(sf::RenderWindow* render_window)
+void MoveablePlatform::draw(Renderer* renderer)
 {
     m_sprite.setPosition(getPosition());
-    render_window->draw(m_sprite);
+    renderer->draw(m_sprite);
 }
 
 void MoveablePlatform::update(int delta_time)
@@ -140,9 +140,9 @@ FallingPlatform::FallingPlatform()
 {
 }
 
-void FallingPlatform::draw(sf::RenderWindow* render_window) {
+void FallingPlatform::draw(Renderer* renderer) {
     m_sprite.setPosition(getPosition());
-    render_window->draw(m_sprite);
+    renderer->draw(m_sprite);
 }
 
 void FallingPlatform::setSpeed(const Vector& speed) {
@@ -227,8 +227,8 @@ void PlatformSystem::onStarted() {
     addChild(m_right_platform);
 }
 
-void PlatformSystem::draw(sf::RenderWindow* render_window) {
-    GameObject::draw(render_window);
+void PlatformSystem::draw(Renderer* renderer) {
+    GameObject::draw(renderer);
 
     int WIDTH = getBounds().width();
     int width = getBounds().width() / 6;
@@ -236,14 +236,14 @@ void PlatformSystem::draw(sf::RenderWindow* render_window) {
     int right_shoulder = m_right_platform->getPosition().y - getPosition().y - 32;
 
     m_sprite_sheet.setPosition(getPosition() + Vector(width - 16, 0));
-    m_sprite_sheet.draw(render_window, 0);
+    m_sprite_sheet.draw(renderer, 0);
 
     m_sprite_sheet.setPosition(getPosition() + Vector(WIDTH - width - 16, 0));
-    m_sprite_sheet.draw(render_window, 1);
+    m_sprite_sheet.draw(renderer, 1);
 
-    m_sprite_sheet.draw(render_window, 2, Rect(width + 16, 0, WIDTH * 2 / 3 - 32, 32).moved(getPosition()), RepeatMode::REPEAT);
-    m_sprite_sheet.draw(render_window, 3, Rect(width - 16, 32, 32, left_shoulder).moved(getPosition()), RepeatMode::REPEAT);
-    m_sprite_sheet.draw(render_window, 4, Rect(WIDTH - 16 - width, 32, 32, right_shoulder).moved(getPosition()), RepeatMode::REPEAT);
+    m_sprite_sheet.draw(renderer, 2, Rect(width + 16, 0, WIDTH * 2 / 3 - 32, 32).moved(getPosition()), RepeatMode::REPEAT);
+    m_sprite_sheet.draw(renderer, 3, Rect(width - 16, 32, 32, left_shoulder).moved(getPosition()), RepeatMode::REPEAT);
+    m_sprite_sheet.draw(renderer, 4, Rect(WIDTH - 16 - width, 32, 32, right_shoulder).moved(getPosition()), RepeatMode::REPEAT);
 }
 
 void PlatformSystem::update(int delta_time) {
@@ -277,9 +277,9 @@ Jumper::Jumper() {
     m_animator.create("low",    texture, { 64, 52, 32, 32 });
 }
 
-void Jumper::draw(sf::RenderWindow* render_window) {
+void Jumper::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void Jumper::update(int delta_time) {
@@ -354,7 +354,7 @@ Ladder::Ladder()
     setSize({ 10, 32 });
 }
 
-void Ladder::draw(sf::RenderWindow* render_window) {
+void Ladder::draw(Renderer* renderer) {
     const int BLOCK_HEIGHT = 32;
 
     int k = getBounds().height() / BLOCK_HEIGHT;
@@ -370,7 +370,7 @@ void Ladder::draw(sf::RenderWindow* render_window) {
 
         m_sprite.setTextureRect({{212, top}, {BLOCK_HEIGHT, height}});
         m_sprite.setPosition(sf::Vector2f(pos_x, i * BLOCK_HEIGHT + getPosition().y));
-        render_window->draw(m_sprite);
+        renderer->draw(m_sprite);
     }
 }
 
@@ -407,10 +407,10 @@ FireBar::FireBar() {
         }, 0.01f);
 }
 
-void FireBar::FireBar::draw(sf::RenderWindow* render_window) {
+void FireBar::FireBar::draw(Renderer* renderer) {
     for (const auto& fire_pos : m_fire_pos) {
         m_animator.setPosition(fire_pos);
-        m_animator.draw(render_window);
+        m_animator.draw(renderer);
     }
 }
 
@@ -557,9 +557,9 @@ EndLevelFlag::EndLevelFlag() {
     m_animator.create("base", *MARIO_GAME.textureManager().get("Items"), { 0,180 }, { 32,32 }, 4, 1, 0.01f);
 }
 
-void EndLevelFlag::draw(sf::RenderWindow* render_window)  {
+void EndLevelFlag::draw(Renderer* renderer)  {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void EndLevelFlag::update(int delta_time) {
@@ -588,9 +588,9 @@ void EndLevelKey::onStarted() {
     m_blocks = getParent()->findChildObjectByType<Blocks>();
 }
 
-void EndLevelKey::draw(sf::RenderWindow* render_window) {
+void EndLevelKey::draw(Renderer* renderer) {
     m_sprite.setPosition(getPosition());
-    render_window->draw(m_sprite);
+    renderer->draw(m_sprite);
 }
 
 void EndLevelKey::enterState(State state) {
@@ -706,10 +706,10 @@ void CastleFlag::liftUp() {
     m_pos_y -= 64;
 }
 
-void CastleFlag::draw(sf::RenderWindow* render_window)
+void CastleFlag::draw(Renderer* renderer)
 {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void CastleFlag::update(int delta_time) {
@@ -725,9 +725,9 @@ Princess::Princess() {
     m_animator.create("stay", *MARIO_GAME.textureManager().get("Items"), { 222,96,32,64 });
 }
 
-void Princess::draw(sf::RenderWindow* render_window) {
+void Princess::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 //---------------------------------------------------------------------------
 // ! Trigger
@@ -18,7 +18,7 @@ public:
 class Jumper : public Item {
 public:
     Jumper();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void collsionResponse(Mario* mario, ECollisionTag& collision_tag, int delta_time) override;
 
@@ -51,7 +51,7 @@ enum class PlatformType : uint8_t {
 class MoveablePlatform : public Platform {
 public:
     MoveablePlatform();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     Vector getSpeedVector() override;
     void collsionResponse(Mario* mario, ECollisionTag& collision_tag, int delta_time) override;
@@ -78,7 +78,7 @@ private:
 class FallingPlatform : public Platform {
 public:
     FallingPlatform();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     Vector getSpeedVector() override;
     void addImpulse(const Vector& speed);
@@ -100,7 +100,7 @@ class PlatformSystem : public GameObject {
  public:
     PlatformSystem();
     void onStarted() override;
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
 
  private:
@@ -118,7 +118,7 @@ class Ladder : public GameObject {
 
  public:
     Ladder();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void onStarted() override;
 
@@ -131,7 +131,7 @@ private:
 class FireBar : public GameObject {
 public:
     FireBar();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
 
 protected:
@@ -187,7 +187,7 @@ private:
 class EndLevelFlag : public GameObject {
 public:
     EndLevelFlag();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
 
 private:
@@ -206,7 +206,7 @@ class Blocks;
 class EndLevelKey : public GameObject {
 public:
     EndLevelKey();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
 
 private:
@@ -239,7 +239,7 @@ class CastleFlag : public GameObject {
 public:
     CastleFlag();
     void liftUp();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
 
 private:
@@ -254,7 +254,7 @@ class Princess : public GameObject {
 
 public:
     Princess();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
 
 private:
     Animator m_animator;
@@ -51,9 +51,9 @@ MarioBullet::MarioBullet(const Vector& pos, const Vector& direction) {
         Vector(31,0), Vector(16,16), 3,1, 0.02f, AnimType::FORWARD_BACKWARD_CYCLE);
 }
 
-void MarioBullet::draw(sf::RenderWindow* render_window) {
+void MarioBullet::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void MarioBullet::setState(State state) {
@@ -153,6 +153,9 @@ Mario::Mario() {
                           { sf::Color(64,128,0), sf::Color(96,160,0),sf::Color(192,192,128),sf::Color(224,224,128), sf::Color(255,251,240) });
     m_black_pallete.create({ sf::Color(64,64,128), sf::Color(64,96,192), sf::Color(160,32,0), sf::Color(192,0,64), sf::Color(224,32,64) },
                            { sf::Color(128,64,0), sf::Color(160,96,0),sf::Color(20,20,10),sf::Color(30,30,20), sf::Color(0,0,0) });
+    // swapped textures are shared between levels, only the first Mario builds them
+    m_fire_pallete.getTexture(texture);
+    m_black_pallete.getTexture(texture);
     m_animator->play("idle_small");
     m_animator->setOrigin("seat_big", -Vector::UP*12);
 }
@@ -295,9 +298,9 @@ MarioRank Mario::getRank() const {
     return m_rank;
 }
 
-void Mario::draw(sf::RenderWindow* render_window) {
+void Mario::draw(Renderer* renderer) {
     m_animator->setPosition(getPosition());
-    m_animator->draw(render_window);
+    m_animator->draw(renderer);
 }
 
 void Mario::kickBlocksProcessing() {
@@ -18,7 +18,7 @@ private:
         SPLASH = 1
     };
 
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void setState(State state);
     void onStarted() override;
@@ -110,7 +110,7 @@ private:
     bool canFire() const;
     void jump();
     bool canJump() const;
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void inputProcessing(float delta_time);
     void physicProcessing(float delta_time);
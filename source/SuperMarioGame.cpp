@@ -1,13 +1,18 @@
-#include <iomanip>
+#include <algorithm>
+#include <assert.h>
 #include <cmath>
+#include <filesystem>
+#include <limits>
 #include <stdexcept>
+#include <tuple>
 
 #include <cstdio>  // for sscanf
 
-#include "tinyxml2.h"
 #include <Format.hpp>
+#include <LevelFormat.hpp>
 
 #include "Blocks.hpp"
+#include "Effects.hpp"
 #include "Enemies.hpp"
 
 #include "Pickups.hpp"
@@ -27,7 +32,11 @@ struct Resource {
     std::string filePath;
 };
 
-const std::string TEXTURES_DIR = MARIO_RES_PATH + "Textures/";
+// relative to MARIO_RES_PATH, the same names are used as asset pack entries
+const std::string TEXTURES_DIR = "Textures/";
+const std::string BACKGROUNDS_DIR = "Backgrounds/";
+const std::string ASSET_PACK_NAME = "assets.pak";
+const int MUSIC_CROSSFADE_TIME = 300; // ms, between scenes and after invincibility
 
 const std::vector<Resource> TEXTURE_RES = {
     { "Mario",      "Mario.png"},
@@ -44,39 +53,84 @@ const std::vector<Resource> TEXTURE_RES = {
     { "Water",      "Backgrounds/Water.png"}
 };
 
+TextureManager::Loader textureLoader(AssetLoader::Source source) {
+    return [source]() {
+        auto texture = std::make_unique<sf::Texture>();
+        const bool loaded = source.data.empty() ? texture->loadFromFile(source.path)
+                                                : texture->loadFromMemory(source.data.data(), source.data.size());
+        return loaded ? std::move(texture) : nullptr;
+    };
+}
+
+std::string levelPath(const std::string& level_name) {
+    return MARIO_RES_PATH + "Levels/" + level_name + ".tmx";
+}
+
 };
 
 MarioGame::MarioGame()
     : Game("SuperMario", { 1920, 1080 }) {
     LOG("MARIO_GAME", INFO, "Mario game created");
 
-    //Load textures
-    for (auto texture : TEXTURE_RES) {
-        textureManager().loadFromFile(texture.name, TEXTURES_DIR + texture.filePath);
+    // one mapped archive if it was packed at build time, loose files otherwise
+    const bool packed = assetPack().open(MARIO_RES_PATH + ASSET_PACK_NAME);
+    auto source = [this, packed](const std::string& path) {
+        return AssetLoader::Source{ MARIO_RES_PATH + path, packed ? assetPack().find(path) : std::span<const uint8_t>() };
+    };
 
-        if (texture.name.find("Backgrounds") != std::string::npos) {
-            textureManager().get(texture.name)->setRepeated(true);
+    // decoded in parallel, textures are uploaded here as they become ready
+    // backgrounds are loaded on first use by a level and may be evicted, atlases are used everywhere
+    AssetLoader loader;
+    for (auto texture : TEXTURE_RES) {
+        if (texture.filePath.starts_with(BACKGROUNDS_DIR)) {
+            textureManager().declare(texture.name, textureLoader(source(TEXTURES_DIR + texture.filePath)));
+        } else {
+            loader.addTexture(texture.name, source(TEXTURES_DIR + texture.filePath));
         }
     }
 
-    //Load fonts
-    const std::string fonts_dir = MARIO_RES_PATH + "Fonts/";
     for (auto font : { "arial", "menu_font", "main_font", "score_font", "some_font" }) {
-        fontManager().loadFromFile(font, fonts_dir + font + ".ttf");
+        loader.addFont(font, source(std::string("Fonts/") + font + ".ttf"));
     }
 
-    //Load sounds
-    const std::string sounds_dir = MARIO_RES_PATH + "Sounds/";
     for (auto sound : { "breakblock", "bump", "coin", "fireball", "jump_super", "kick", "stomp","powerup_appears",
         "powerup", "pipe","flagpole", "bowser_falls", "bowser_fire", "mario_die" ,"stage_clear", "squish",
         "game_over","1-up","warning", "world_clear","pause","beep","fireworks" }) {
-        soundManager().loadFromFile(sound, sounds_dir + sound + ".wav");
+        loader.addSound(sound, source(std::string("Sounds/") + sound + ".wav"));
     }
 
-    //Load music
-    const std::string music_dir = MARIO_RES_PATH + "Music/";
     for (auto music : { "overworld", "underworld", "bowsercastle", "underwater", "invincibility" }) {
-        musicManager().loadFromFile(music, music_dir + music + ".ogg");
+        loader.addMusic(music, source(std::string("Music/") + music + ".ogg"));
+    }
+
+    loader.load(textureManager(), fontManager(), soundManager(), musicManager());
+    m_startup_report = loader.report();
+
+    //Jingles must be heard, repeated effects only need a couple of voices
+    const std::tuple<const char*, VoiceManager::Settings> sound_settings[] = {
+        { "mario_die", { 10, 1 } }, { "game_over", { 10, 1 } }, { "stage_clear", { 10, 1 } },
+        { "world_clear", { 10, 1 } }, { "pause", { 10, 1 } }, { "warning", { 10, 1 } },
+        { "1-up", { 5, 0 } }, { "powerup", { 5, 1 } }, { "flagpole", { 5, 1 } }, { "pipe", { 5, 1 } },
+        { "coin", { 0, 3 } }, { "stomp", { 0, 2 } }, { "kick", { 0, 2 } }, { "bump", { 0, 2 } },
+        { "breakblock", { 0, 3 } }, { "fireball", { 0, 2 } }, { "fireworks", { 0, 3 } }
+    };
+    for (const auto& [sound, settings] : sound_settings) {
+        if (auto buffer = soundManager().get(sound)) {
+            voiceManager().setSettings(buffer, settings);
+        }
+    }
+
+    // sprite sources share one atlas page, so mixed frames don't switch textures
+    buildTextureAtlas({ "Mario", "Tiles", "AnimTiles", "Enemies", "Bowser", "Items", "Logo" });
+
+    //Bake glyph atlases of all text styles used in game, no rasterisation while playing
+    const std::tuple<const char*, unsigned> baked_fonts[] = {
+        { "some_font", 36 }, { "some_font", 40 }, { "main_font", 14 }, { "main_font", 20 }
+    };
+    for (auto [font, size] : baked_fonts) {
+        if (auto ttf = fontManager().get(font)) {
+            BitmapFont::get(*ttf, size, sf::Text::Bold);
+        }
     }
 
     //Configure input
@@ -118,18 +172,20 @@ void MarioGame::clearScenes() {
 }
 
 void MarioGame::loadLevel(const std::string& level_name) {
-    if (level_name == "[NEXT_LEVEL]") {
-        m_current_stage_name = nextLevelName();
-    } else {
-        m_current_stage_name = level_name;
+    const std::string stage_name = (level_name == "[NEXT_LEVEL]") ? nextLevelName() : level_name;
+
+    // prototypes of the stage and its sublevels are kept until the stage is left
+    if (stage_name != m_current_stage_name) {
+        m_level_prototypes.clear();
     }
+    m_current_stage_name = stage_name;
 
-    setScene(new MarioGameScene(MARIO_RES_PATH + "Levels/" + m_current_stage_name + ".tmx"));
+    setScene(new MarioGameScene(levelPath(m_current_stage_name)));
     m_gui_object->moveToFront();
 }
 
 void MarioGame::loadSubLevel(const std::string& sublevel_name) {
-    pushScene(new MarioGameScene(MARIO_RES_PATH + "Levels/" + sublevel_name + ".tmx"));
+    pushScene(new MarioGameScene(levelPath(sublevel_name)));
     m_gui_object->moveToFront();
 }
 
@@ -156,8 +212,7 @@ void MarioGame::updateMusic() {
         music = it->second;
     }
 
-    stopMusic();
-    playMusic(music);
+    playMusic(music, MUSIC_CROSSFADE_TIME);
 }
 
 void MarioGame::setScene(GameObject* new_scene) {
@@ -205,6 +260,11 @@ MarioGUI* MarioGame::GUI() {
 }
 
 void MarioGame::init() {
+    // levels refer to presets by name, with a broken presets file their objects come out wrong
+    if (!m_prefabs.load(MARIO_RES_PATH + "Levels/presets.tmx")) {
+        LOG("MARIO_GAME", ERROR, "Presets are missing or broken, levels using them won't be complete");
+        assert(false && "fix Levels/presets.tmx");
+    }
     getRootObject()->addChild(m_gui_object = new MarioGUI());
     setState(GameState::MAIN_MENU);
 }
@@ -248,6 +308,7 @@ void MarioGame::setState(GameState state) {
         musicManager().setPitch(1.f);
         m_delay_timer = 2500;
         stopMusic();
+        voiceManager().stopAll();
         break;
     case GameState::GAME_OVER:
         MARIO_GAME.playSound("game_over");
@@ -310,14 +371,17 @@ void MarioGame::update(int delta_time) {
         break;
     case GameState::PLAYING:
         if (inputManager().isButtonDown("Pause")) {
-            playSound("pause");
             if (m_current_scene->isEnabled()) {
+                // the paused scene's sounds are cut, only the pause one plays
+                voiceManager().stopAll();
+                playSound("pause");
                 m_current_scene->disable();
                 musicManager().pause();
                 m_gui_object->pause(true);
                 globalTimer().setPause(true);
                 break;
             } else {
+                playSound("pause");
                 m_current_scene->enable();
                 musicManager().play();
                 m_gui_object->pause(false);
@@ -389,9 +453,7 @@ void MarioGame::addScore(int value, const Vector& vector) {
     GUI()->setScore(m_score);
 
     if (vector != Vector::ZERO) {
-        auto flow_text = m_gui_object->createFlowText();
-        flow_text->splash(vector, toString(value));
-        m_current_scene->addChild(flow_text);
+        effects()->spawnText(vector, toString(value));
     }
 }
 
@@ -411,9 +473,7 @@ void MarioGame::addLive() {
 
     auto vector = m_current_scene->findChildObjectByType<Mario>()->getBounds().center();
     if (vector != Vector::ZERO) {
-        auto flow_text = m_gui_object->createFlowText();
-        flow_text->splash(vector, "1 up");
-        m_current_scene->addChild(flow_text);
+        effects()->spawnText(vector, "1 up");
     }
 }
 
@@ -473,6 +533,10 @@ GameObject* MarioGame::currentScene() const {
     return m_current_scene;
 }
 
+Effects* MarioGame::effects() const {
+    return m_current_scene->castTo<MarioGameScene>()->effects();
+}
+
 Mario* MarioGame::getPlayer(int index) const {
     (void)index; // unused
 
@@ -499,55 +563,32 @@ TimerManager& MarioGame::globalTimer() {
     return m_timer;
 }
 
-std::map<std::string, Property> parseProperties(tinyxml2::XMLElement* object) {
-    std::map<std::string, Property> parsed;
-
-    //common properties
-    parsed["x"] = toFloat(object->Attribute("x"));
-    parsed["y"] = toFloat(object->Attribute("y"));
-    parsed["width"]  = toFloat(object->Attribute("width"));
-    parsed["height"] = toFloat(object->Attribute("height"));
-    parsed["name"]   = toString(object->Attribute("name"));
- 
-    //specific properties
-    tinyxml2::XMLElement* properties = object->FirstChildElement("properties");
-    if (properties) {
-        for (auto property = properties->FirstChildElement("property"); property; property = property->NextSiblingElement()) {
-
-            std::string type = "string";
-            if (property->Attribute("type")) {
-                type = property->Attribute("type");
-            }
+LevelPrefetcher& MarioGame::levelPrefetcher() {
+    return m_level_prefetcher;
+}
 
-            const std::string& name = property->Attribute("name");
-            const std::string& value = property->Attribute("value");
+const AssetLoader::Report& MarioGame::startupReport() const {
+    return m_startup_report;
+}
 
-            using utils::strHash;
+const PrefabRegistry& MarioGame::prefabs() const {
+    return m_prefabs;
+}
 
-            switch (strHash(type.c_str())) {
-            case strHash("int"):
-                parsed[name] = utils::toInt(value);
-                break;
-            case strHash("float"):
-                parsed[name] = utils::toFloat(value);
-                break;
-            case strHash("bool"):
-                parsed[name] = utils::toBool(value);
-                break;
-            default:
-                parsed[name] = toString(value);
-                break;
-            }
+void MarioGame::prefetchLevels(const std::vector<std::string>& level_names) {
+    auto prefetch = [this](const std::string& name) {
+        const std::string path = levelPath(name);
+        // the next stage after the last one doesn't exist
+        if (std::filesystem::exists(path)) {
+            m_level_prefetcher.prefetch(path);
         }
-    }
+    };
 
-    //parse text element
-    tinyxml2::XMLElement* text_properties = object->FirstChildElement("text");
-    if (text_properties) {
-        parsed["text"] = std::string(text_properties->FirstChild()->Value());
+    for (const auto& name : level_names) {
+        prefetch((name == "[NEXT_LEVEL]") ? nextLevelName() : name);
     }
 
-    return parsed;
+    prefetch(nextLevelName());
 }
 
 template <typename T>
@@ -566,9 +607,7 @@ GameObject* textFabric() {
     return lab;
 }
 
-GameObject* parseGameObject(tinyxml2::XMLElement* element) {
-    std::string obj_type = element->Attribute("type");
-
+ObjectFabric findObjectFabric(std::string_view obj_type) {
     static std::unordered_map<std::string, GameObject* (*)()> fabrics =
     {
         { "Mario",             goFabric<Mario> },
@@ -600,40 +639,31 @@ GameObject* parseGameObject(tinyxml2::XMLElement* element) {
         { "Text",              textFabric }
     }; 
 
-    auto obj_fabric = fabrics.find(obj_type);
-    if (obj_fabric == fabrics.end()) {
-        // no fabric for this object
-        return nullptr;
-    }
+    auto obj_fabric = fabrics.find(std::string(obj_type));
+    return (obj_fabric != fabrics.end()) ? obj_fabric->second : nullptr;
+}
 
-    GameObject* object = obj_fabric->second();
-    auto properties = parseProperties(element);
-    for (const auto& property : properties) {
-        object->setProperty(property.first, property.second);
-    }
+GameObject* createGameObject(const LevelPrototype::ObjectSpec& spec) {
+    GameObject* object = spec.fabric();
+    object->setPropertyTemplate(spec.properties);
+    object->setProperty("x", spec.x);
+    object->setProperty("y", spec.y);
 
     return object;
 }
 
-Blocks* parseBlocks(tinyxml2::XMLElement* element) {
-    tinyxml2::XMLElement* data = element->FirstChildElement("layer")->FirstChildElement("data");
+Blocks* createBlocks(const LevelPrototype& prototype) {
+    auto blocks = new Blocks(prototype.width, prototype.height, prototype.tile_width, prototype.tile_height);
+    blocks->reserveStaticBlocks(prototype.block_count);
 
-    // parse blocks indexes from cvs format (1,20,30,40,3)
-    std::string blocks_indexes_string = data->GetText();
-    std::vector<char> blockData;
-    std::string buf;
+    auto blocks_fabric = [blocks](uint16_t tileCode) -> AbstractBlock* {
+        static const bool INVIZ_STYLE = true, NOT_INVIZ_STYLE = false;
 
-    for (auto chr : blocks_indexes_string) {
-        if (isdigit(chr)) {
-            buf += chr;
-        } else if (!buf.empty()) {
-            blockData.push_back((char)utils::toInt(buf));
-            buf.clear();
+        if (tileCode > std::numeric_limits<std::underlying_type_t<TileCode>>::max()) {
+            LOG("SCENE", WARNING, "Tile id %u is out of the tileset, skipped", tileCode);
+            return nullptr;
         }
-    }
 
-    static auto blocks_fabric = [](char tileCode) -> AbstractBlock* {
-        static const bool INVIZ_STYLE = true, NOT_INVIZ_STYLE = false;
         auto tileId = static_cast<TileCode>(tileCode);
 
         switch (tileId) {
@@ -644,7 +674,7 @@ Blocks* parseBlocks(tinyxml2::XMLElement* element) {
         case TileCode::COIN_BOX:
             return new CoinBoxBlock(tileId);
         case TileCode::QUESTION_ONE_COIN:
-            return new QuestionBlock(tileId, prize<TwistedCoin>());
+            return new QuestionBlock(tileId, coinPrize());
         case TileCode::QUESTION_MUSHROOM:
             return new QuestionBlock(tileId, prize<Mushroom>());
         case TileCode::BRICK_MUSHROOM:
@@ -658,25 +688,194 @@ Blocks* parseBlocks(tinyxml2::XMLElement* element) {
         case TileCode::INVIZ_UP:
             return new QuestionBlock(tileId, prize<OneUpMushroom>());
         case TileCode::INVIZ_COIN:
-            return new QuestionBlock(tileId, prize<TwistedCoin>());
+            return new QuestionBlock(tileId, coinPrize());
         case TileCode::BRICK_LIVE_UP:
             return new QuestionBlock(tileId, prize<OneUpMushroom>());
         case TileCode::BRICK_STAR:
             return new QuestionBlock(tileId, prize<Star>());
         default:
-            return new StaticBlock(tileId);
+            return blocks->createStaticBlock(tileId);
         }
     };
 
-    auto blocks = new Blocks(toInt(element->Attribute("width")),
-                             toInt(element->Attribute("height")),
-                             toInt(element->Attribute("tilewidth")),
-                             toInt(element->Attribute("tileheight")));
-
-    blocks->loadFromArray(blockData, blocks_fabric);
+    blocks->loadFromArray(prototype.tiles.data(), prototype.tiles.size(), blocks_fabric);
     return blocks;
 }
 
+// appends the record in a form that tells apart equal property sets
+void appendPropertyKey(std::string& key, const level::LevelView& level, const level::PropertyRecord& property) {
+    key += level.string(property.name);
+    key += '\0';
+    key += static_cast<char>(property.type);
+    if (property.type == level::PropertyType::STRING) {
+        key += level.string(property.string_value);
+    } else {
+        key.append(reinterpret_cast<const char*>(&property.int_value), sizeof(property.int_value));
+    }
+    key += '\0';
+}
+
+std::shared_ptr<LevelPrototype> buildLevelPrototype(const level::LevelView& level, const PrefabRegistry& prefabs) {
+    auto prototype = std::make_shared<LevelPrototype>();
+
+    const level::Header& header = level.header();
+    prototype->width = header.width;
+    prototype->height = header.height;
+    prototype->tile_width = header.tile_width;
+    prototype->tile_height = header.tile_height;
+    prototype->tiles.assign(level.tiles(), level.tiles() + level.tileCount());
+    prototype->block_count = prototype->tiles.size() - std::count(prototype->tiles.begin(), prototype->tiles.end(), 0);
+
+    // fabrics are resolved once per object type
+    std::vector<ObjectFabric> fabrics(level.typeCount());
+    for (uint32_t type = 0; type < level.typeCount(); ++type) {
+        fabrics[type] = findObjectFabric(level.typeName(type));
+    }
+
+    // objects with equal properties share one typed copy of them
+    std::unordered_map<std::string, std::shared_ptr<const GameObject::PropertyMap>> templates;
+    std::string key;
+
+    for (uint32_t i = 0; i < level.objectCount(); ++i) {
+        const level::ObjectRecord& record = level.objects()[i];
+        const level::PropertyRecord* properties = level.properties(record);
+
+        const PrefabRegistry::Prefab* prefab = nullptr;
+        key.clear();
+        for (uint32_t p = 0; p < record.property_count; ++p) {
+            if (level.string(properties[p].name) == "Prefab" && properties[p].type == level::PropertyType::STRING) {
+                const std::string prefab_name(level.string(properties[p].string_value));
+                prefab = prefabs.find(prefab_name);
+                if (!prefab) {
+                    LOG("MARIO_GAME", WARNING, "Unknown prefab %s", prefab_name.c_str());
+                } else {
+                    key = prefab_name;
+                }
+                break;
+            }
+        }
+
+        LevelPrototype::ObjectSpec spec;
+        spec.fabric = fabrics[record.type] ? fabrics[record.type] : (prefab ? prefab->fabric : nullptr);
+        if (!spec.fabric) {
+            // no fabric for this object
+            continue;
+        }
+
+        key += '\n';
+        for (uint32_t p = 0; p < record.property_count; ++p) {
+            const std::string_view name = level.string(properties[p].name);
+            if (name == "x") {
+                spec.x = level.toProperty(properties[p]).asFloat();
+            } else if (name == "y") {
+                spec.y = level.toProperty(properties[p]).asFloat();
+            } else if (name != "Prefab") {
+                appendPropertyKey(key, level, properties[p]);
+            }
+        }
+
+        auto& shared = templates[key];
+        if (!shared) {
+            auto merged = std::make_shared<GameObject::PropertyMap>(prefab ? prefab->properties : GameObject::PropertyMap());
+            for (uint32_t p = 0; p < record.property_count; ++p) {
+                const std::string_view name = level.string(properties[p].name);
+                if (name != "x" && name != "y" && name != "Prefab") {
+                    (*merged)[std::string(name)] = level.toProperty(properties[p]);
+                }
+            }
+            shared = std::move(merged);
+        }
+        spec.properties = shared;
+
+        if (spec.fabric == goFabric<LevelPortal>) {
+            for (const char* name : { "Level", "SubLevel" }) {
+                auto target = spec.properties->find(name);
+                if (target != spec.properties->end() && !target->second.asString().empty()) {
+                    prototype->reachable_levels.push_back(target->second.asString());
+                }
+            }
+        }
+
+        prototype->objects.push_back(std::move(spec));
+    }
+
+    prototype->property_templates = templates.size();
+    return prototype;
+}
+
+//---------------------------------------------------------------------------
+//! PrefabRegistry
+//---------------------------------------------------------------------------
+bool PrefabRegistry::load(const std::string& tmx_path) {
+    level::LevelFile file;
+    if (!file.load(tmx_path)) {
+        LOG("MARIO_GAME", WARNING, "Can't load prefabs from %s", tmx_path.c_str());
+        return false;
+    }
+
+    bool valid = true;
+    const level::LevelView& view = file.view();
+    for (uint32_t i = 0; i < view.objectCount(); ++i) {
+        const level::ObjectRecord& record = view.objects()[i];
+        Prefab prefab;
+        prefab.fabric = findObjectFabric(view.typeName(record.type));
+        if (!prefab.fabric) {
+            continue;
+        }
+
+        std::string name;
+        const level::PropertyRecord* properties = view.properties(record);
+        for (uint32_t p = 0; p < record.property_count; ++p) {
+            const std::string property_name(view.string(properties[p].name));
+            if (property_name == "name") {
+                name = view.toProperty(properties[p]).asString();
+            } else if (property_name != "x" && property_name != "y") {
+                prefab.properties.emplace(property_name, view.toProperty(properties[p]));
+            }
+        }
+
+        if (name.empty()) {
+            LOG("MARIO_GAME", WARNING, "Unnamed %s prefab skipped", std::string(view.typeName(record.type)).c_str());
+        } else if (!m_prefabs.emplace(name, std::move(prefab)).second) {
+            // levels refer to prefabs by name, one of the two would be silently lost
+            LOG("MARIO_GAME", ERROR, "Duplicated prefab name %s in %s", name.c_str(), tmx_path.c_str());
+            valid = false;
+        }
+    }
+
+    LOG("MARIO_GAME", INFO, "%zu prefabs loaded from %s", m_prefabs.size(), tmx_path.c_str());
+    return valid;
+}
+
+const PrefabRegistry::Prefab* PrefabRegistry::find(const std::string& name) const {
+    auto it = m_prefabs.find(name);
+    return (it != m_prefabs.end()) ? &it->second : nullptr;
+}
+
+size_t PrefabRegistry::size() const {
+    return m_prefabs.size();
+}
+
+std::shared_ptr<const LevelPrototype> MarioGame::levelPrototype(const std::string& tmx_path) {
+    auto it = m_level_prototypes.find(tmx_path);
+    if (it != m_level_prototypes.end()) {
+        return it->second;
+    }
+
+    // usually prefetched by the previous scene
+    auto level_file = m_level_prefetcher.acquire(tmx_path);
+    if (!level_file) {
+        return nullptr;
+    }
+
+    std::shared_ptr<const LevelPrototype> prototype = buildLevelPrototype(level_file->view(), m_prefabs);
+    m_level_prototypes.emplace(tmx_path, prototype);
+    LOG("MARIO_GAME", INFO, "%s: %zu objects share %zu property sets", tmx_path.c_str(),
+        prototype->objects.size(), prototype->property_templates);
+    prefetchLevels(prototype->reachable_levels);
+    return prototype;
+}
+
 void MarioGameScene::loadFromFile(const std::string& filepath) {
     setName("MarioGameScene");
     m_level_name = filepath;
@@ -689,22 +888,20 @@ void MarioGameScene::loadFromFile(const std::string& filepath) {
     //@TODO: use filesystem to extract file name
 
     removeChildObjects();
-    tinyxml2::XMLDocument documet;
-    bool status = documet.LoadFile(filepath.c_str());
-    assert(status == tinyxml2::XML_SUCCESS); // cant load file
-    tinyxml2::XMLElement* root_element = documet.FirstChildElement();
+    m_effects = nullptr;
+    // built on the first entry, restarts don't touch the level file at all
+    auto prototype = MARIO_GAME.levelPrototype(filepath);
+    if (!prototype) {
+        throw std::runtime_error("Can't load level " + filepath);
+    }
 
     //Load tilemap
-    m_blocks = parseBlocks(root_element);
+    m_blocks = createBlocks(*prototype);
     addChild(m_blocks);
 
     //Load objects
-    tinyxml2::XMLElement* objects = root_element->FirstChildElement("objectgroup");
-    for (auto obj = objects->FirstChildElement("object"); obj ; obj = obj->NextSiblingElement()) {
-        auto object = parseGameObject(obj);
-        if (object) {
-            addChild(object);
-        }
+    for (const auto& spec : prototype->objects) {
+        addChild(createGameObject(spec));
     }
 
     // Arrange objects Z-order
@@ -726,12 +923,21 @@ void MarioGameScene::loadFromFile(const std::string& filepath) {
     if (background) {
         background->moveToBack();
     }
+
 }
 
 const std::string& MarioGameScene::getLevelName() const {
     return m_level_name;
 }
 
+Effects* MarioGameScene::effects() {
+    if (!m_effects) {
+        addChild(m_effects = new Effects());
+    }
+
+    return m_effects;
+}
+
 void MarioGameScene::init() {
     setName("MarioGameScene");
     m_view.setSize(screen_size);
@@ -762,21 +968,71 @@ void MarioGameScene::update(int delta_time) {
     m_camera_rect = Rect(Vector(m_view.getCenter()) - Vector(m_view.getSize()) * 0.5, m_view.getSize());
 }
 
-void MarioGameScene::draw(sf::RenderWindow* render_window) {
+void MarioGameScene::draw(Renderer* renderer) {
     if (!isVisible()) {
         return;
     }
 
-    render_window->setView(m_view);
+    // scaled scene goes to a smaller texture which is stretched over the target,
+    // the GUI is a separate object drawn after and stays at native resolution
+    sf::RenderTarget* target = renderer->getTarget();
+    const float scale = MARIO_GAME.resolutionGovernor().getScale();
+    const bool scaled = target && scale < 1.f && prepareSceneTarget(target->getSize(), scale);
+
+    if (scaled) {
+        renderer->setTarget(m_scene_target.get());
+        m_scene_target->clear(sf::Color::Transparent);
+    }
+
+    renderer->setView(m_view);
     const auto& camera_rect = cameraRect();
 
     for (auto& obj : getChilds()) {
         if (obj->isVisible() && camera_rect.isIntersect(obj->getBounds())) {
-            obj->draw(render_window);
+            obj->draw(renderer);
         }
     }
 
-    render_window->setView(render_window->getDefaultView());
+    if (scaled) {
+        renderer->flush();
+        m_scene_target->display();
+        renderer->setTarget(target);
+    }
+
+    renderer->setView(renderer->getDefaultView());
+
+    if (scaled) {
+        // target holds alpha-blended, so premultiplied colors
+        sf::RenderStates states(sf::BlendMode(sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha));
+        const sf::Vector2u target_size = target->getSize();
+        sf::Sprite sprite(m_scene_target->getTexture());
+        sprite.setScale({ (float)target_size.x / m_scene_target_size.x, (float)target_size.y / m_scene_target_size.y });
+        renderer->draw(sprite, states);
+    }
+}
+
+bool MarioGameScene::prepareSceneTarget(const sf::Vector2u& target_size, float scale) {
+    const sf::Vector2u size(std::max(1u, (unsigned)(target_size.x * scale)),
+                            std::max(1u, (unsigned)(target_size.y * scale)));
+
+    if (m_scene_target && m_scene_target_size == size) {
+        return true;
+    }
+
+    if (!m_scene_target) {
+        m_scene_target = std::make_unique<sf::RenderTexture>();
+    }
+
+    if (!m_scene_target->resize(size)) {
+        LOG("SCENE", ERROR, "Failed to create %ux%u scene target, drawing at native resolution", size.x, size.y);
+        MARIO_GAME.resolutionGovernor().setEnabled(false);
+        m_scene_target.reset();
+        return false;
+    }
+
+    m_scene_target->setSmooth(true);
+    m_scene_target_size = size;
+    return true;
 }
 
 void MarioGameScene::events(const sf::Event& event) {
@@ -816,26 +1072,38 @@ MarioGameScene::~MarioGameScene() {
 //---------------------------------------------------------------------------
 MarioGUI::MarioGUI() {
     const int y_gui_pos = 5;
-    m_score_lab = new Label();
-    m_score_lab->setFontName(*MARIO_GAME.fontManager().get("some_font"));
+    const float status_bar_height = 64.f;
+
+    // score, coins, world and time are redrawn into the cached bar only when changed
+    m_status_bar = new CachedLayer({ MARIO_GAME.screenSize().x, status_bar_height });
+    addChild(m_status_bar);
+
+    auto setupLabel = [](Label* label) {
+        label->setFontName(*MARIO_GAME.fontManager().get("some_font"));
+        label->setFontStyle(sf::Text::Bold);
+        label->setFontColor({255,255,220});
+        label->setFontSize(40);
+        label->setTextAlign(Label::left);
+    };
+
+    m_score_lab = new NumberLabel("MARIO: ", 6);
+    setupLabel(m_score_lab);
     m_score_lab->setPosition({ 70,y_gui_pos });
-    m_score_lab->setFontStyle(sf::Text::Bold);
-    m_score_lab->setFontColor({255,255,220});
-    m_score_lab->setFontSize(40);
-    m_score_lab->setTextAlign(Label::left);
-    addChild(m_score_lab);
+    m_status_bar->addChild(m_score_lab);
 
-    m_coin_counter_lab = createLabel();
+    m_coin_counter_lab = new NumberLabel("x", 2);
+    setupLabel(m_coin_counter_lab);
     m_coin_counter_lab->setPosition({ 490, y_gui_pos });
-    addChild(m_coin_counter_lab);
+    m_status_bar->addChild(m_coin_counter_lab);
 
     m_world_lab = createLabel();
     m_world_lab->setPosition({ 720, y_gui_pos });
-    addChild(m_world_lab);
+    m_status_bar->addChild(m_world_lab);
 
-    m_timer = createLabel();
+    m_timer = new NumberLabel("TIME: ", 3);
+    setupLabel(m_timer);
     m_timer->setPosition({ 1080, y_gui_pos });
-    addChild(m_timer);
+    m_status_bar->addChild(m_timer);
 
     m_level_name = createLabel();
     m_level_name->setPosition(MARIO_GAME.screenSize() / 2.f + Vector::UP*100.f);
@@ -858,12 +1126,6 @@ MarioGUI::MarioGUI() {
     addChild(m_mario_pix);
     m_fire_pallete.create({ sf::Color(202,77,62), sf::Color(132,133,30) }, { sf::Color(255,255,255), sf::Color(202,77,62) });
 
-    m_flow_text = new FlowText(*MARIO_GAME.fontManager().get("main_font"));
-    m_flow_text->setTextColor(sf::Color::Red);
-    m_flow_text->setSplashVector({ 0,-3 });
-    m_flow_text->setTextSize(14);
-    addChild(m_flow_text);
-
     const auto scr_size = MARIO_GAME.screenSize();
 
     m_game_logo = new Label(sf::Sprite(*MARIO_GAME.textureManager().get("Logo"), sf::IntRect( {0,0}, {750, 300})));
@@ -927,30 +1189,39 @@ void MarioGUI::update(int delta_time) {
     }
 }
 
-void MarioGUI::draw(sf::RenderWindow* render_window) {
-    GameObject::draw(render_window);
+void MarioGUI::draw(Renderer* renderer) {
+    GameObject::draw(renderer);
 }
 
 void MarioGUI::setScore(int value) {
-    std::stringstream str_stream;
-    str_stream << "MARIO: " << std::setw(6) << std::setfill('0') << value;
-    m_score_lab->setString(str_stream.str());
+    const int old_value = m_score_lab->getValue();
+    m_score_lab->setValue(value);
+
+    if (m_score_lab->getValue() != old_value) {
+        m_status_bar->invalidate();
+    }
 }
 
 void MarioGUI::setCoins(int value) {
-    std::stringstream str_stream;
-    str_stream << "x" << std::setw(2) << std::setfill('0') << value;
-    m_coin_counter_lab->setString(str_stream.str());
+    const int old_value = m_coin_counter_lab->getValue();
+    m_coin_counter_lab->setValue(value);
+
+    if (m_coin_counter_lab->getValue() != old_value) {
+        m_status_bar->invalidate();
+    }
 }
 
 void MarioGUI::setGameTime(int time) {
-    std::stringstream str_stream;
-    str_stream << "TIME: " << std::setw(3) << std::setfill('0') << time;
-    m_timer->setString(str_stream.str());
+    const int old_value = m_timer->getValue();
+    m_timer->setValue(time);
+
+    if (m_timer->getValue() != old_value) {
+        m_status_bar->invalidate();
+    }
 }
 
-FlowText* MarioGUI::createFlowText() {
-    return m_flow_text->clone();
+void MarioGUI::setStatusBarCached(bool cached) {
+    m_status_bar->setCacheEnabled(cached);
 }
 
 Label* MarioGUI::createLabel() {
@@ -989,6 +1260,7 @@ void MarioGUI::setState(GUIState state) {
 void MarioGUI::setLevelName(const std::string& string) {
     m_level_name->setString(string);
     m_world_lab->setString(string);
+    m_status_bar->invalidate();
 }
 
 void MarioGUI::setLives(int value) {
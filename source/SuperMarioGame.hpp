@@ -1,16 +1,62 @@
 #ifndef SUPER_MARIO_GAME_HPP
 #define SUPER_MARIO_GAME_HPP
 
+#include "AssetLoader.hpp"
 #include "GameEngine.hpp"
+#include "LevelPrefetcher.hpp"
 #include "Mario.hpp"
 
 #define MARIO_GAME (*MarioGame::instance())
 
 const std::string MARIO_RES_PATH = "res/";
 
+class Effects;
 class MarioGameScene;
 class MarioGUI;
 
+using ObjectFabric = GameObject* (*)();
+
+/// @brief Immutable level content, built once per stage and instantiated on every (re)start.
+struct LevelPrototype {
+    struct ObjectSpec {
+        ObjectFabric fabric = nullptr;
+        std::shared_ptr<const GameObject::PropertyMap> properties; //!< shared by objects with equal properties
+        float x = 0.f;
+        float y = 0.f;
+    };
+
+    int width = 0;
+    int height = 0;
+    int tile_width = 0;
+    int tile_height = 0;
+    std::vector<uint16_t> tiles;
+    size_t block_count = 0;            //!< non-empty tiles
+    std::vector<ObjectSpec> objects;
+    size_t property_templates = 0;     //!< distinct property sets among objects
+    std::vector<std::string> reachable_levels; //!< LevelPortal targets
+};
+
+/// @brief Object presets from presets.tmx, loaded once at startup.
+///
+/// A level object refers to a preset by its name with the "Prefab" property
+/// and lists only the properties that differ. The object type may be omitted,
+/// it's taken from the preset then. Preset names must be unique, load()
+/// fails on a duplicate.
+class PrefabRegistry {
+public:
+    struct Prefab {
+        ObjectFabric fabric = nullptr;
+        GameObject::PropertyMap properties; //!< without position and name
+    };
+
+    bool load(const std::string& tmx_path);
+    const Prefab* find(const std::string& name) const;
+    size_t size() const;
+
+private:
+    std::unordered_map<std::string, Prefab> m_prefabs;
+};
+
 class MarioGame : public Game {
 public:
     ~MarioGame() = default;
@@ -30,6 +76,7 @@ public:
     Label* createText(const std::string& text, const Vector& pos);
     void marioDied();
     GameObject* currentScene() const;
+    Effects* effects() const;
     Mario* getPlayer(int index = 0) const;
     void playSound(const std::string& name, const Vector& pos);
     void playSound(const std::string& name);
@@ -42,6 +89,25 @@ public:
     }
 
     TimerManager& globalTimer();
+    LevelPrefetcher& levelPrefetcher();
+    const PrefabRegistry& prefabs() const;
+
+    /*
+     * @brief Per asset decode and upload times of the startup loading
+     */
+    const AssetLoader::Report& startupReport() const;
+
+    /*
+     * @brief Prototype of the level, loaded and built on the first request
+     * @return nullptr if the level can't be loaded
+     */
+    std::shared_ptr<const LevelPrototype> levelPrototype(const std::string& tmx_path);
+
+    /*
+     * @brief Start loading levels reachable from the current scene in background
+     * @param level_names [in] - level names, "[NEXT_LEVEL]" is resolved, the next stage is always added
+     */
+    void prefetchLevels(const std::vector<std::string>& level_names);
 
 private:
 
@@ -79,6 +145,10 @@ private:
     GameState m_game_state = GameState::MAIN_MENU;
     TimeOutState m_time_out_state = TimeOutState::NONE;
     TimerManager m_timer;
+    LevelPrefetcher m_level_prefetcher;
+    PrefabRegistry m_prefabs;
+    AssetLoader::Report m_startup_report;
+    std::unordered_map<std::string, std::shared_ptr<const LevelPrototype>> m_level_prototypes;
     std::vector<GameObject*> m_scene_stack;
     std::string m_level_name;
     std::string m_current_stage_name;
@@ -108,13 +178,15 @@ public:
     Vector screenToPoint(const Vector& vector);
     void playSoundAtPoint(const std::string& name, const Vector& pos);
     const std::string& getLevelName() const;
+    Effects* effects();
 
 private:
     MarioGameScene();
     void init();
     void update(int delta_time) override;
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void events(const sf::Event& event) override;
+    bool prepareSceneTarget(const sf::Vector2u& target_size, float scale);
 
     sf::View m_view;
     static constexpr float SCALE_FACTOR = 1.5f;
@@ -122,7 +194,10 @@ private:
     std::string m_level_name;
     Mario* m_mario = nullptr;
     Blocks* m_blocks = nullptr;
+    Effects* m_effects = nullptr;
     Rect m_camera_rect;
+    std::unique_ptr<sf::RenderTexture> m_scene_target; //!< scene drawn below native resolution
+    sf::Vector2u m_scene_target_size;
 };
 
 enum class GUIState : uint8_t {
@@ -142,23 +217,24 @@ public:
     void setLives(int value);
     void setMarioRank(MarioRank rank);
     void setState(GUIState state);
-    FlowText* createFlowText();
     Label* createLabel();
     void update(int delta_time) override;
     void pause(bool ispaused);
+    void setStatusBarCached(bool cached);
 
 private:
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
 
     GUIState m_state;
     int m_tmr = 0;
     Animator* m_mario_pix = nullptr;
     Animator* m_coin = nullptr;
     Pallete m_fire_pallete;
-    Label* m_score_lab = nullptr;
-    Label* m_coin_counter_lab = nullptr;
+    CachedLayer* m_status_bar = nullptr;
+    NumberLabel* m_score_lab = nullptr;
+    NumberLabel* m_coin_counter_lab = nullptr;
     Label* m_world_lab = nullptr;
-    Label* m_timer = nullptr;
+    NumberLabel* m_timer = nullptr;
     Label* m_level_name = nullptr;
     Label* m_lives = nullptr;
     Label* m_game_logo = nullptr;
@@ -167,7 +243,6 @@ private:
     Label* m_menu_selector = nullptr;
     Label* m_game_over_lab = nullptr;
     Label* m_paused_label = nullptr;
-    FlowText* m_flow_text = nullptr;
 };
 
 #endif // !SUPER_MARIO_GAME_HPP
@@ -0,0 +1,172 @@
+#include <algorithm>
+
+#include "TileRenderer.hpp"
+
+void TileRenderer::create(int cols, int rows, const Vector& tile_size, int layers, TileSource source) {
+    m_cols = cols;
+    m_rows = rows;
+    m_tile_size = tile_size;
+    m_source = std::move(source);
+    m_chunk_cols = (cols + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    m_chunk_rows = (rows + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    m_chunks.clear();
+    m_chunks.resize(m_chunk_cols * m_chunk_rows);
+    m_layer_regions.assign(layers, TextureAtlas::Region());
+
+    for (auto& chunk : m_chunks) {
+        chunk.layers.assign(layers, sf::VertexArray(sf::PrimitiveType::Triangles));
+    }
+}
+
+void TileRenderer::invalidate(int x, int y) {
+    if (x < 0 || y < 0 || x >= m_cols || y >= m_rows) {
+        return;
+    }
+
+    m_chunks[(x / CHUNK_SIZE) + (y / CHUNK_SIZE) * m_chunk_cols].dirty = true;
+}
+
+void TileRenderer::invalidateAll() {
+    for (auto& chunk : m_chunks) {
+        chunk.dirty = true;
+    }
+}
+
+void TileRenderer::setAnimationSpeed(float speed) {
+    m_animation_speed = speed;
+}
+
+void TileRenderer::update(int delta_time) {
+    m_animation_time += delta_time;
+    m_animation_frame = static_cast<int>(m_animation_time * m_animation_speed);
+}
+
+int TileRenderer::animationFrame() const {
+    return m_animation_frame;
+}
+
+bool TileRenderer::chunkRange(const Rect& tiles_rect, sf::IntRect& range) const {
+    const int left = std::max(0, static_cast<int>(tiles_rect.left()));
+    const int top = std::max(0, static_cast<int>(tiles_rect.top()));
+    const int right = std::min(m_cols, static_cast<int>(tiles_rect.right()));
+    const int bottom = std::min(m_rows, static_cast<int>(tiles_rect.bottom()));
+
+    if (left >= right || top >= bottom) {
+        return false;
+    }
+
+    range.position = { left / CHUNK_SIZE, top / CHUNK_SIZE };
+    range.size = { (right - 1) / CHUNK_SIZE - range.position.x + 1,
+                   (bottom - 1) / CHUNK_SIZE - range.position.y + 1 };
+    return true;
+}
+
+void TileRenderer::draw(Renderer* renderer, const Rect& tiles_rect, int layer, const sf::RenderStates& states) {
+    sf::IntRect range;
+    if (!chunkRange(tiles_rect, range)) {
+        return;
+    }
+
+    bakeAtlas(renderer, layer, states.texture);
+    sf::RenderStates chunk_states = states;
+    if (m_layer_regions[layer].page) {
+        chunk_states.texture = m_layer_regions[layer].page;
+    }
+
+    for (int cy = range.position.y; cy < range.position.y + range.size.y; ++cy) {
+        for (int cx = range.position.x; cx < range.position.x + range.size.x; ++cx) {
+            Chunk& chunk = m_chunks[cx + cy * m_chunk_cols];
+
+            if (chunk.dirty) {
+                rebuild(cx, cy, chunk);
+            }
+
+            if (chunk.frame != m_animation_frame) {
+                animate(chunk);
+            }
+
+            const sf::VertexArray& vertices = chunk.layers[layer];
+            if (vertices.getVertexCount()) {
+                renderer->draw(vertices, chunk_states);
+            }
+        }
+    }
+}
+
+void TileRenderer::bakeAtlas(const Renderer* renderer, int layer, const sf::Texture* texture) {
+    const TextureAtlas* atlas = renderer->getAtlas();
+    const TextureAtlas::Region* found = atlas ? atlas->find(texture) : nullptr;
+    const TextureAtlas::Region region = found ? *found : TextureAtlas::Region();
+
+    TextureAtlas::Region& baked = m_layer_regions[layer];
+    if (baked.page != region.page || baked.offset != region.offset) {
+        // the atlas has changed, rebuild chunks in its space
+        baked = region;
+        invalidateAll();
+    }
+}
+
+void TileRenderer::rebuild(int chunk_x, int chunk_y, Chunk& chunk) {
+    for (auto& layer : chunk.layers) {
+        layer.clear();
+    }
+    chunk.animated.clear();
+
+    const int x_end = std::min(m_cols, (chunk_x + 1) * CHUNK_SIZE);
+    const int y_end = std::min(m_rows, (chunk_y + 1) * CHUNK_SIZE);
+
+    for (int y = chunk_y * CHUNK_SIZE; y < y_end; ++y) {
+        for (int x = chunk_x * CHUNK_SIZE; x < x_end; ++x) {
+            Tile tile;
+            if (!m_source(x, y, tile)) {
+                continue;
+            }
+
+            const sf::Vector2f pos(x * m_tile_size.x, y * m_tile_size.y);
+            const sf::Vector2f size(m_tile_size.x, m_tile_size.y);
+            const sf::Vector2f uv = sf::Vector2f(tile.texture_rect.position) + m_layer_regions[tile.layer].offset;
+            const sf::Vector2f uv_size(tile.texture_rect.size);
+
+            const sf::Vertex quad[6] = {
+                { pos,                                 sf::Color::White, uv },
+                { pos + sf::Vector2f(size.x, 0),       sf::Color::White, uv + sf::Vector2f(uv_size.x, 0) },
+                { pos + sf::Vector2f(0, size.y),       sf::Color::White, uv + sf::Vector2f(0, uv_size.y) },
+                { pos + sf::Vector2f(0, size.y),       sf::Color::White, uv + sf::Vector2f(0, uv_size.y) },
+                { pos + sf::Vector2f(size.x, 0),       sf::Color::White, uv + sf::Vector2f(uv_size.x, 0) },
+                { pos + size,                          sf::Color::White, uv + uv_size }
+            };
+
+            sf::VertexArray& vertices = chunk.layers[tile.layer];
+
+            if (tile.frames > 1) {
+                chunk.animated.push_back({ tile.layer, vertices.getVertexCount(), uv.x, uv_size.x, tile.frames });
+            }
+
+            for (const auto& vertex : quad) {
+                vertices.append(vertex);
+            }
+        }
+    }
+
+    chunk.dirty = false;
+    animate(chunk);
+}
+
+void TileRenderer::animate(Chunk& chunk) {
+    chunk.frame = m_animation_frame;
+
+    for (const auto& quad : chunk.animated) {
+        const float left = quad.left + (m_animation_frame % quad.frames) * quad.width;
+        const float right = left + quad.width;
+        sf::VertexArray& vertices = chunk.layers[quad.layer];
+
+        // same vertex order as in rebuild(): left, right, left, left, right, right
+        vertices[quad.first_vertex + 0].texCoords.x = left;
+        vertices[quad.first_vertex + 1].texCoords.x = right;
+        vertices[quad.first_vertex + 2].texCoords.x = left;
+        vertices[quad.first_vertex + 3].texCoords.x = left;
+        vertices[quad.first_vertex + 4].texCoords.x = right;
+        vertices[quad.first_vertex + 5].texCoords.x = right;
+    }
+}
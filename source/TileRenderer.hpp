@@ -0,0 +1,121 @@
+#ifndef TILE_RENDERER_HPP
+#define TILE_RENDERER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "Rect.hpp"
+#include "Renderer.hpp"
+#include "TextureAtlas.hpp"
+#include "Vector.hpp"
+
+/// @brief Chunked tile layer renderer.
+///
+/// Tiles are baked into one vertex array per chunk and per layer, so a visible
+/// chunk costs one draw call per non-empty layer instead of one per tile.
+/// Chunks are rebuilt lazily, only after being invalidated.
+///
+/// Animated tiles are baked as well: their frames are laid out horizontally in
+/// the texture, and the frame index is computed once per tick from a global
+/// clock. Each chunk keeps an index list of its animated quads and patches their
+/// texture coordinates when it is drawn with a new frame.
+///
+/// With a renderer atlas, texture coordinates are baked in the atlas page
+/// space, so chunks are drawn as they are, without remapping each vertex.
+class TileRenderer {
+public:
+    static constexpr int CHUNK_SIZE = 16; //!< chunk size in tiles
+
+    /// @brief Baked tile description.
+    struct Tile {
+        sf::IntRect texture_rect;
+        int layer = 0;
+        int frames = 1; //!< animation frames, placed to the right of texture_rect
+    };
+
+    /// @brief Tile source, returns false for cells that have nothing to draw.
+    using TileSource = std::function<bool(int x, int y, Tile& tile)>;
+
+    /*
+     * @brief Create chunks for a map, all chunks are dirty after creation
+     * @param cols [in] - map width in tiles
+     * @param rows [in] - map height in tiles
+     * @param tile_size [in] - tile size in pixels
+     * @param layers [in] - number of layers
+     * @param source [in] - tile source used for chunks rebuilding
+     */
+    void create(int cols, int rows, const Vector& tile_size, int layers, TileSource source);
+
+    /*
+     * @brief Mark the chunk which contains given tile as dirty
+     */
+    void invalidate(int x, int y);
+
+    /*
+     * @brief Mark all chunks as dirty
+     */
+    void invalidateAll();
+
+    /*
+     * @brief Set animation speed of animated tiles
+     * @param speed [in] - frames per millisecond
+     */
+    void setAnimationSpeed(float speed);
+
+    /*
+     * @brief Advance global animation clock
+     */
+    void update(int delta_time);
+
+    /*
+     * @brief Current global animation frame (not wrapped by frames count)
+     */
+    int animationFrame() const;
+
+    /*
+     * @brief Draw one layer of the chunks intersecting given tiles rect
+     * @param renderer [in] - renderer
+     * @param tiles_rect [in] - visible area in tile coordinates
+     * @param layer [in] - layer index
+     * @param states [in] - render states (texture, shader etc.)
+     */
+    void draw(Renderer* renderer, const Rect& tiles_rect, int layer, const sf::RenderStates& states);
+
+private:
+    struct AnimatedQuad {
+        int layer;
+        std::size_t first_vertex;
+        float left;  //!< first frame left texture coordinate
+        float width;
+        int frames;
+    };
+
+    struct Chunk {
+        std::vector<sf::VertexArray> layers;
+        std::vector<AnimatedQuad> animated;
+        int frame = 0;
+        bool dirty = true;
+    };
+
+    void bakeAtlas(const Renderer* renderer, int layer, const sf::Texture* texture);
+    void rebuild(int chunk_x, int chunk_y, Chunk& chunk);
+    void animate(Chunk& chunk);
+    bool chunkRange(const Rect& tiles_rect, sf::IntRect& range) const;
+
+    int m_cols = 0;
+    int m_rows = 0;
+    int m_chunk_cols = 0;
+    int m_chunk_rows = 0;
+    Vector m_tile_size;
+    std::vector<Chunk> m_chunks;
+    std::vector<TextureAtlas::Region> m_layer_regions;  //!< atlas space chunks are baked in, no page - texture space
+    TileSource m_source;
+    float m_animation_speed = 0.f;
+    int64_t m_animation_time = 0;
+    int m_animation_frame = 0;
+};
+
+#endif // TILE_RENDERER_HPP
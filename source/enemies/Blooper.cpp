@@ -50,9 +50,9 @@ void Blooper::update(int delta_time) {
     }
 }
 
-void Blooper::draw(sf::RenderWindow* render_window) {
+void Blooper::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void Blooper::takeDamage(DamageType damageType, Character* attacker) {
@@ -6,7 +6,7 @@ class Blooper : public Enemy {
 public:
     Blooper();
     void update(int delta_time) override;
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     //! ICharacter impl:
     void takeDamage(DamageType damageType, Character* attacker) override;
     void touch(Character* character) override;
@@ -18,9 +18,9 @@ Bowser::Bowser() {
     m_animator.setOrigin("turn", Vector::DOWN * 5);
 }
 
-void Bowser::draw(sf::RenderWindow* render_window) {
+void Bowser::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void Bowser::noBridge() {
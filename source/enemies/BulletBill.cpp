@@ -12,9 +12,9 @@ BulletBill::BulletBill(const Vector& initial_pos, const Vector& initial_speed) {
     setState(State::NORMAL);
 }
 
-void BulletBill::draw(sf::RenderWindow* render_window) {
+void BulletBill::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void BulletBill::update(int delta_time) {
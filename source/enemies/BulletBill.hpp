@@ -5,7 +5,7 @@
 class BulletBill : public Enemy {
 public:
     BulletBill(const Vector& infitial_pos, const Vector& initial_speed);
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     //! ICharacter impl:
     void takeDamage(DamageType damageType, Character* attacker) override;
@@ -72,9 +72,9 @@ bool BuzzyBeetle::isAlive() const {
     return (m_state != State::DIED);
 }
 
-void BuzzyBeetle::draw(sf::RenderWindow* render_window) {
+void BuzzyBeetle::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void BuzzyBeetle::setState(State state) {
@@ -23,9 +23,9 @@ CheepCheep::CheepCheep() {
     setState(State::UNDERWATER);
 }
 
-void CheepCheep::draw(sf::RenderWindow* render_window) {
+void CheepCheep::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void CheepCheep::update(int delta_time) {
@@ -6,7 +6,7 @@ class CheepCheep : public Enemy {
 public:
     CheepCheep();
     CheepCheep(const Vector& initial_pos, const Vector& initial_speed);
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     //! ICharacter impl:
     void takeDamage(DamageType damageType, Character* attacker) override;
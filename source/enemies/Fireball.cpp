@@ -10,9 +10,9 @@ Fireball::Fireball(const Vector& Position, const Vector& SpeedVector) {
     m_animator.setOrigin("fire", { 16,18 });
 }
 
-void Fireball::draw(sf::RenderWindow* render_window) {
+void Fireball::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void Fireball::update(int delta_time) {
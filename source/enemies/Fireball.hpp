@@ -5,7 +5,7 @@
 class Fireball : public GameObject {
 public:
     Fireball(const Vector& Position, const Vector& SpeedVector);
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
 
 private:
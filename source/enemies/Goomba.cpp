@@ -8,26 +8,35 @@ Goomba::Goomba() {
     m_animator.create("squashed", texture, { 64, 0, 32, 32 });
     m_animator.create("fall",    texture, { 0, 32, 32, -32 });
     m_animator.setSpriteOffset("squashed", 0, { 0,8 });
+}
 
-    m_stateMachine.attachOnEnterMap<>(&m_animator, &Animator::play,
-        {{ State::WALKING , "walk"    },
-         { State::SQUASHED, "squashed"},
-         { State::DIED    , "fall"    }
-        });
+// built at compile time, every Goomba uses this table
+constexpr Goomba::Transitions Goomba::TRANSITIONS = [] {
+    Transitions table;
+    table.addTransition(Event::ENTERED_VIEW  , State::DEACTIVATED, State::WALKING, &Goomba::enterWalking);
+    table.addTransition(Event::PROJECTILE_HIT, State::WALKING,     State::DIED,    &Goomba::enterDead);
+    table.addTransition(Event::STOMPED       , State::WALKING,     State::SQUASHED,&Goomba::enterSquashed);
+    table.setStateCallback(&Goomba::playStateAnimation);
+    return table;
+}();
 
-    m_stateMachine.addTransition(Event::ENTERED_VIEW  , State::DEACTIVATED, State::WALKING, [this]() { enterWalking(); });
-    m_stateMachine.addTransition(Event::PROJECTILE_HIT, State::WALKING,     State::DIED,    [this]() { enterDead();    });
-    m_stateMachine.addTransition(Event::STOMPED       , State::WALKING,     State::SQUASHED,[this]() { enterSquashed();});
-    m_stateMachine.start(State::DEACTIVATED);
+void Goomba::playStateAnimation(State state) {
+    switch (state) {
+    case State::WALKING:     m_animator.play("walk");     break;
+    case State::SQUASHED:    m_animator.play("squashed"); break;
+    case State::DIED:        m_animator.play("fall");     break;
+    case State::DEACTIVATED:
+    case State::COUNT:       break;
+    }
 }
 
 void Goomba::update(int delta_time) {
     Enemy::update(delta_time);
 
-    switch (m_stateMachine.getState()) {
+    switch (m_state) {
     case State::DEACTIVATED:
         if (isInCamera()) {
-            m_stateMachine.dispatchEvent(Event::ENTERED_VIEW);
+            TRANSITIONS.dispatchEvent(*this, m_state, Event::ENTERED_VIEW);
         }
         break;
     case State::WALKING:
@@ -44,19 +53,21 @@ void Goomba::update(int delta_time) {
             removeLater();
         }
         break;
+    case State::COUNT:
+        break;
     }
 }
 
-void Goomba::draw(sf::RenderWindow* render_window) {
+void Goomba::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void Goomba::takeDamage(DamageType damageType, Character*) {
     if (damageType == DamageType::HIT_FROM_ABOVE) {
-        m_stateMachine.dispatchEvent(Event::STOMPED);
+        TRANSITIONS.dispatchEvent(*this, m_state, Event::STOMPED);
     } else {
-        m_stateMachine.dispatchEvent(Event::PROJECTILE_HIT);
+        TRANSITIONS.dispatchEvent(*this, m_state, Event::PROJECTILE_HIT);
     }
 }
 
@@ -65,7 +76,7 @@ void Goomba::touch(Character* character) {
 }
 
 bool Goomba::isAlive() const {
-    return (m_stateMachine.getState() == State::WALKING);
+    return (m_state == State::WALKING);
 }
 
 void Goomba::enterWalking() {
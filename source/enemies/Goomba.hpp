@@ -7,7 +7,7 @@
 class Goomba : public Enemy {
 public:
     Goomba();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     //! ICharacter impl:
     void takeDamage(DamageType damageType, Character* attacker) override;
@@ -21,20 +21,26 @@ private:
         STOMPED        = 1,
         BUMPED         = 2,
         PROJECTILE_HIT = 3,
+        COUNT
     };
 
     enum class State : uint8_t {
         DEACTIVATED = 0,
         WALKING     = 1,
         SQUASHED    = 2,
-        DIED        = 3
+        DIED        = 3,
+        COUNT
     };
 
     void enterWalking();
     void enterSquashed();
     void enterDead();
+    void playStateAnimation(State state);
 
-    fsm::StateMachine<State, Event> m_stateMachine;
+    using Transitions = fsm::TransitionTable<Goomba, State, Event>;
+    static const Transitions TRANSITIONS;
+
+    State m_state = State::DEACTIVATED;
     float m_timer = 0;
 };
 
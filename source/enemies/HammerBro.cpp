@@ -36,9 +36,9 @@ void Hammer::throwAway(const Vector& speed) {
     m_state = State::FLY;
 }
 
-void Hammer::draw(sf::RenderWindow* render_window) {
+void Hammer::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 //---------------------------------------------------------------------------
 //! HammerBro
@@ -53,9 +53,9 @@ HammerBro::HammerBro() {
     m_velocity.x = RUN_SPEED;
 }
 
-void HammerBro::draw(sf::RenderWindow* render_window) {
+void HammerBro::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void HammerBro::update(int delta_time) {
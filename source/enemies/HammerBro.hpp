@@ -7,7 +7,7 @@ public:
     Hammer(Mario* target);
     void update(int delta_time) override;
     void throwAway(const Vector& speed);
-    void draw(sf::RenderWindow* render_window);
+    void draw(Renderer* renderer);
 
 private:
 
@@ -28,7 +28,7 @@ private:
 class HammerBro : public Enemy {
 public:
     HammerBro();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void onStarted() override;
     //! ICharacter impl:
@@ -18,34 +18,44 @@ Koopa::Koopa() {
     m_animator.create("hidden", texture, { 64,48,32,32 });
     m_animator.create("bullet", texture, { 64, 48 }, { 32, 32 }, 4, 1, 0.01f);
     m_animator.create("fall",   texture, { 0,80, 32, -48 });
+}
 
-    //                            timeout          timeout         stomped
-    //                              ╭---- [WAKING] -----╮    ╭------------------╮
-    //                stomped       ↓       stomped     |    ↓   kicked         |
-    //  [LEVITATING] ----------→ [WALKING] ----------→ [HIDDEN] -------→ [SHELL_SLIDING]
-    //                stomped       ↑
-    //  [JUMPING] ------------------╯           hit_by_projectile / bumped
-    //                                  <ANY_STATE> ---------------------→ [DEAD]
-
-    m_stateMachine.addTransition(Event::STOMPED, State::LEVITATING,    State::WALKING,         [this]() { enterWalking(); });
-    m_stateMachine.addTransition(Event::STOMPED, State::JUMPING,       State::WALKING,         [this]() { enterWalking(); });
-    m_stateMachine.addTransition(Event::STOMPED, State::WALKING,       State::HIDDEN,          [this]() { enterShell(); });
-    m_stateMachine.addTransition(Event::KICKED,  State::HIDDEN,        State::SHELL_SLIDING,   [this]() { enterShellSliding(); });
-    m_stateMachine.addTransition(Event::STOMPED, State::SHELL_SLIDING, State::HIDDEN,          [this]() { exitShellSliding(); });
-    m_stateMachine.addTransition(Event::TIMEOUT, State::HIDDEN,        State::WAKING);
-    m_stateMachine.addTransition(Event::TIMEOUT, State::WAKING,        State::WALKING,         [this]() { exitShell(); enterWalking(); });
-    m_stateMachine.addTransition(Event::STOMPED, State::HIDDEN,        State::SHELL_SLIDING,   [this]() { enterShellSliding(); });
-    m_stateMachine.addTransition(Event::PROJECTILE_HIT, fsm::ANY_STATE,State::DEAD,            [this]() { enterDead(); });
-
-    m_stateMachine.attachOnEnterMap<>(&m_animator, &Animator::play,
-        { { State::JUMPING       , "flying" },
-          { State::LEVITATING    , "flying" },
-          { State::WALKING       , "walk"   },
-          { State::HIDDEN        , "hidden" },
-          { State::SHELL_SLIDING , "bullet" },
-          { State::WAKING        , "climb"  },
-          { State::DEAD          , "fall"   },
-        });
+//                            timeout          timeout         stomped
+//                              ╭---- [WAKING] -----╮    ╭------------------╮
+//                stomped       ↓       stomped     |    ↓   kicked         |
+//  [LEVITATING] ----------→ [WALKING] ----------→ [HIDDEN] -------→ [SHELL_SLIDING]
+//                stomped       ↑
+//  [JUMPING] ------------------╯           hit_by_projectile / bumped
+//                                  <ANY_STATE> ---------------------→ [DEAD]
+
+// built at compile time, every Koopa uses this table
+constexpr Koopa::Transitions Koopa::TRANSITIONS = [] {
+    Transitions table;
+    table.addTransition(Event::STOMPED, State::LEVITATING,    State::WALKING,         &Koopa::enterWalking);
+    table.addTransition(Event::STOMPED, State::JUMPING,       State::WALKING,         &Koopa::enterWalking);
+    table.addTransition(Event::STOMPED, State::WALKING,       State::HIDDEN,          &Koopa::enterShell);
+    table.addTransition(Event::KICKED,  State::HIDDEN,        State::SHELL_SLIDING,   &Koopa::enterShellSliding);
+    table.addTransition(Event::STOMPED, State::SHELL_SLIDING, State::HIDDEN,          &Koopa::exitShellSliding);
+    table.addTransition(Event::TIMEOUT, State::HIDDEN,        State::WAKING);
+    table.addTransition(Event::TIMEOUT, State::WAKING,        State::WALKING,         &Koopa::wakeUp);
+    table.addTransition(Event::STOMPED, State::HIDDEN,        State::SHELL_SLIDING,   &Koopa::enterShellSliding);
+    table.addTransition(Event::PROJECTILE_HIT, fsm::ANY_STATE,State::DEAD,            &Koopa::enterDead);
+    table.setStateCallback(&Koopa::playStateAnimation);
+    return table;
+}();
+
+void Koopa::playStateAnimation(State state) {
+    switch (state) {
+    case State::JUMPING:
+    case State::LEVITATING:    m_animator.play("flying"); break;
+    case State::WALKING:       m_animator.play("walk");   break;
+    case State::HIDDEN:        m_animator.play("hidden"); break;
+    case State::SHELL_SLIDING: m_animator.play("bullet"); break;
+    case State::WAKING:        m_animator.play("climb");  break;
+    case State::DEAD:          m_animator.play("fall");   break;
+    case State::DEACTIVATED:
+    case State::COUNT:         break;
+    }
 }
 
 void Koopa::exitShell() {
@@ -77,6 +87,11 @@ void Koopa::enterWalking() {
     setVelocity({ RUN_SPEED, 0});
 }
 
+void Koopa::wakeUp() {
+    exitShell();
+    enterWalking();
+}
+
 void Koopa::enterDead() {
     m_velocity.x = 0;
     m_velocity.y = -0.4f;
@@ -87,7 +102,7 @@ void Koopa::enterDead() {
 void Koopa::update(int delta_time) {
     Enemy::update(delta_time);
  
-    const auto state = m_stateMachine.getState();
+    const auto state = m_state;
 
     bool physicsAndCollisionsOn = (state != State::DEAD) &&
                                   (state != State::LEVITATING) &&
@@ -106,7 +121,7 @@ void Koopa::update(int delta_time) {
     case State::DEACTIVATED:
         if (isInCamera()) {
             // setState(m_initial_state);
-            m_stateMachine.start(m_initial_state);
+            TRANSITIONS.start(*this, m_state, m_initial_state);
             m_velocity.x = RUN_SPEED;
         }
         break;
@@ -125,13 +140,13 @@ void Koopa::update(int delta_time) {
     case State::HIDDEN:
         m_timer += delta_time;
         if (m_timer > 3000) {
-            m_stateMachine.dispatchEvent(Event::TIMEOUT);
+            TRANSITIONS.dispatchEvent(*this, m_state, Event::TIMEOUT);
         }
         break;
     case State::WAKING:
         m_timer += delta_time;
         if (m_timer > 5000) {
-            m_stateMachine.dispatchEvent(Event::TIMEOUT);
+            TRANSITIONS.dispatchEvent(*this, m_state, Event::TIMEOUT);
         }
         break;
     case State::SHELL_SLIDING:
@@ -143,6 +158,8 @@ void Koopa::update(int delta_time) {
     case State::DEAD:
         updatePhysics(delta_time, GRAVITY_FORCE);
         break;
+    case State::COUNT:
+        break;
     }
 }
 
@@ -152,22 +169,22 @@ void Koopa::takeDamage(DamageType damageType, Character* attacker) {
     }
 
     if (damageType == DamageType::HIT_FROM_ABOVE) {
-        m_stateMachine.dispatchEvent(Event::STOMPED);
+        TRANSITIONS.dispatchEvent(*this, m_state, Event::STOMPED);
         MARIO_GAME.playSound("stomp");
 
     } else {
-        m_stateMachine.dispatchEvent(Event::PROJECTILE_HIT);
+        TRANSITIONS.dispatchEvent(*this, m_state, Event::PROJECTILE_HIT);
     }
 }
 
 void Koopa::touch(Character* character) {
-    auto state = m_stateMachine.getState();
+    auto state = m_state;
 
     bool isKickable = (state == State::HIDDEN)        || (state == State::WAKING);
     bool isDanger   = (state == State::SHELL_SLIDING) || (state == State::WALKING);
 
     if (isKickable) {
-        m_stateMachine.dispatchEvent(Event::KICKED);
+        TRANSITIONS.dispatchEvent(*this, m_state, Event::KICKED);
         addScoreToPlayer(400);
         MARIO_GAME.playSound("kick");
     }
@@ -176,13 +193,13 @@ void Koopa::touch(Character* character) {
     }
 }
 
-void Koopa::draw(sf::RenderWindow* render_window) {
+void Koopa::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 bool Koopa::isAlive() const {
-    return (m_stateMachine.getState() != State::DEAD);
+    return (m_state != State::DEAD);
 }
 
 void Koopa::onStarted() {
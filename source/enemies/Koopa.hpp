@@ -7,7 +7,7 @@
 class Koopa : public Enemy {
 public:
     Koopa();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     //! ICharacter impl:
     void takeDamage(DamageType damageType, Character* attacker) override;
@@ -23,6 +23,7 @@ private:
         BUMPED         = 3, ///< The block/platform beneath was hit from below, bumping the actor upward.
         KICKED         = 4, ///< The actor (or shell) was pushed from the side, giving it horizontal impulse.
         TIMEOUT        = 5, ///< Fired when the shell's wake-up timer expires (HIDDEN -> WAKING -> NORMAL).
+        COUNT
     };
 
     enum class State : uint8_t {
@@ -33,7 +34,8 @@ private:
         HIDDEN        = 4, ///< Shell on ground, stationary (can be STOMPED/KICKED/BUMPED).
         WAKING        = 5, ///< Shell wiggling/peeking; after timeout returns to NORMAL.
         SHELL_SLIDING = 6, ///< Sliding shell acting as a projectile.
-        DEAD          = 7  ///< Dead/falling; pending despawn.
+        DEAD          = 7, ///< Dead/falling; pending despawn.
+        COUNT
     };
 
     //void setState(State state);
@@ -46,14 +48,19 @@ private:
     void exitShellSliding();
 
     void enterWalking();
+    void wakeUp();
     void enterDead();
+    void playStateAnimation(State state);
+
+    using Transitions = fsm::TransitionTable<Koopa, State, Event>;
+    static const Transitions TRANSITIONS;
 
     const Vector FULL_SIZE   = { 32,48 };
     const Vector HIDDEN_SIZE = { 32,32 };
 
     State m_initial_state = State::WALKING;
 
-    fsm::StateMachine<State, Event> m_stateMachine;
+    State m_state = State::DEACTIVATED;
 
     float m_timer = 0;
     Vector m_initial_pos;
@@ -17,9 +17,9 @@ Spinny::Spinny(const Vector& position, const Vector& speed, const Vector& walk_d
     setState(State::EGG);
 }
 
-void Spinny::draw(sf::RenderWindow* render_window) {
+void Spinny::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void Spinny::setState(State state) {
@@ -97,9 +97,9 @@ Lakity::Lakity() {
     setState(State::NORMAL);
 }
 
-void Lakity::draw(sf::RenderWindow* render_window) {
+void Lakity::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void Lakity::update(int delta_time) {
@@ -5,7 +5,7 @@
 class Spinny : public Enemy {
 public:
     Spinny(const Vector& position, const Vector& speed, const Vector& walk_direction);
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void takeDamage(DamageType damageType, Character* attacker) override;
     void touch(Character* character) override;
@@ -30,7 +30,7 @@ class Lakity : public Enemy {
 
 public:
     Lakity();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void runAway(const Vector& run_direction);
     //! ICharacter impl:
@@ -31,9 +31,9 @@ void PiranhaPlant::touch(Character* character) {
     }
 }
 
-void PiranhaPlant::draw(sf::RenderWindow* render_window) {
+void PiranhaPlant::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void PiranhaPlant::update(int delta_time) {
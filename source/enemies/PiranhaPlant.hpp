@@ -7,7 +7,7 @@ class PiranhaPlant : public Enemy {
 
 public:
     PiranhaPlant();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void onStarted() override;
     void hideInTube();
@@ -22,9 +22,9 @@ void Podoboo::touch(Character* character) {
     character->takeDamage(DamageType::SHOOT, character);
 }
 
-void Podoboo::draw(sf::RenderWindow* render_window) {
+void Podoboo::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void Podoboo::update(int delta_time) {
@@ -5,7 +5,7 @@
 class Podoboo : public Enemy {
 public:
     Podoboo();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void onStarted() override;
     //! ICharacter impl:
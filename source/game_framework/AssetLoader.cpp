@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "AssetLoader.hpp"
+#include "Logger.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    float elapsedMs(Clock::time_point from) {
+        return std::chrono::duration<float, std::milli>(Clock::now() - from).count();
+    }
+
+    const char* kindName(AssetLoader::Kind kind) {
+        switch (kind) {
+        case AssetLoader::Kind::TEXTURE: return "texture";
+        case AssetLoader::Kind::FONT:    return "font";
+        case AssetLoader::Kind::SOUND:   return "sound";
+        default:                         return "music";
+        }
+    }
+
+    template <typename T>
+    bool commit(ResourceManager<T>& manager, const std::string& name, std::unique_ptr<T>& resource) {
+        return resource && manager.add(name, resource.release());
+    }
+}
+
+void AssetLoader::addTexture(const std::string& name, Source source) {
+    add(Kind::TEXTURE, name, std::move(source));
+}
+
+void AssetLoader::addFont(const std::string& name, Source source) {
+    add(Kind::FONT, name, std::move(source));
+}
+
+void AssetLoader::addSound(const std::string& name, Source source) {
+    add(Kind::SOUND, name, std::move(source));
+}
+
+void AssetLoader::addMusic(const std::string& name, Source source) {
+    add(Kind::MUSIC, name, std::move(source));
+}
+
+void AssetLoader::add(Kind kind, const std::string& name, Source source) {
+    auto job = std::make_unique<Job>();
+    job->timing.name = name;
+    job->timing.kind = kind;
+    job->source = std::move(source);
+    m_jobs.push_back(std::move(job));
+}
+
+size_t AssetLoader::load(ResourceManager<sf::Texture>& textures,
+                         ResourceManager<sf::Font>& fonts,
+                         ResourceManager<sf::SoundBuffer>& sounds,
+                         ResourceManager<MusicTrack>& music,
+                         unsigned workers) {
+    const auto start = Clock::now();
+
+    if (!workers) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers = static_cast<unsigned>(std::min<size_t>(workers, std::max<size_t>(1, m_jobs.size())));
+
+    m_next_job = 0;
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < workers; ++i) {
+        threads.emplace_back(&AssetLoader::workerLoop, this);
+    }
+
+    size_t failed = 0;
+    for (auto& job : m_jobs) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done_cv.wait(lock, [&job] { return job->done; });
+        }
+
+        Timing& timing = job->timing;
+        switch (timing.kind) {
+        case Kind::TEXTURE:
+            if (job->image) {
+                const auto upload_start = Clock::now();
+                auto texture = std::make_unique<sf::Texture>();
+                if (texture->loadFromImage(*job->image)) {
+                    timing.loaded = commit(textures, timing.name, texture);
+                }
+                timing.upload_ms = elapsedMs(upload_start);
+                job->image.reset();
+            }
+            break;
+        case Kind::FONT:
+            timing.loaded = commit(fonts, timing.name, job->font);
+            break;
+        case Kind::SOUND:
+            timing.loaded = commit(sounds, timing.name, job->sound);
+            break;
+        case Kind::MUSIC:
+            timing.loaded = commit(music, timing.name, job->music);
+            break;
+        }
+
+        if (!timing.loaded) {
+            LOG("ASSET_LOADER", ERROR, "Failed to load %s %s", kindName(timing.kind), timing.name.c_str());
+            ++failed;
+        }
+        m_report.assets.push_back(timing);
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    m_jobs.clear();
+    m_report.workers = workers;
+    m_report.wall_ms = elapsedMs(start);
+    return failed;
+}
+
+const AssetLoader::Report& AssetLoader::report() const {
+    return m_report;
+}
+
+void AssetLoader::decode(Job& job) {
+    const auto start = Clock::now();
+    const Source& source = job.source;
+    const bool in_memory = !source.data.empty();
+    bool decoded = false;
+
+    switch (job.timing.kind) {
+    case Kind::TEXTURE:
+        job.image = std::make_unique<sf::Image>();
+        decoded = in_memory ? job.image->loadFromMemory(source.data.data(), source.data.size())
+                            : job.image->loadFromFile(source.path);
+        break;
+    case Kind::FONT:
+        job.font = std::make_unique<sf::Font>();
+        decoded = in_memory ? job.font->openFromMemory(source.data.data(), source.data.size())
+                            : job.font->openFromFile(source.path);
+        break;
+    case Kind::SOUND:
+        job.sound = std::make_unique<sf::SoundBuffer>();
+        decoded = in_memory ? job.sound->loadFromMemory(source.data.data(), source.data.size())
+                            : job.sound->loadFromFile(source.path);
+        break;
+    case Kind::MUSIC:
+        job.music = std::make_unique<MusicTrack>();
+        decoded = in_memory ? job.music->loadFromMemory(source.data.data(), source.data.size())
+                            : job.music->loadFromFile(source.path);
+        break;
+    }
+
+    if (!decoded) {
+        job.image.reset();
+        job.font.reset();
+        job.sound.reset();
+        job.music.reset();
+    }
+
+    std::error_code ec;
+    job.timing.bytes = in_memory ? source.data.size() : static_cast<size_t>(std::filesystem::file_size(source.path, ec));
+    job.timing.decode_ms = elapsedMs(start);
+}
+
+void AssetLoader::workerLoop() {
+    // jobs are taken in submission order, which is also the upload order
+    for (size_t index = m_next_job++; index < m_jobs.size(); index = m_next_job++) {
+        Job& job = *m_jobs[index];
+        decode(job);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            job.done = true;
+        }
+        m_done_cv.notify_all();
+    }
+}
+
+void AssetLoader::Report::log() const {
+    float decode_total = 0.f;
+    float upload_total = 0.f;
+
+    for (const Timing& asset : assets) {
+        LOG("ASSET_LOADER", INFO, "%-8s %-16s decode %7.2f ms, upload %6.2f ms%s", kindName(asset.kind),
+            asset.name.c_str(), asset.decode_ms, asset.upload_ms, asset.loaded ? "" : ", FAILED");
+        decode_total += asset.decode_ms;
+        upload_total += asset.upload_ms;
+    }
+
+    // the serial sum is what loading took before it was spread over workers
+    LOG("ASSET_LOADER", INFO, "%zu assets on %u workers: %.1f ms wall, decode %.1f ms + upload %.1f ms serial, %.1fx",
+        assets.size(), workers, wall_ms, decode_total, upload_total,
+        wall_ms > 0.f ? (decode_total + upload_total) / wall_ms : 0.f);
+}
@@ -0,0 +1,96 @@
+#ifndef ASSET_LOADER_HPP
+#define ASSET_LOADER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "MusicEngine.hpp"
+#include "ResourceManager.hpp"
+
+/// @brief Decodes a batch of assets on a thread pool.
+///
+/// PNG decoding to sf::Image, sound buffers, fonts and music intros are
+/// decoded on worker threads. Only the texture upload runs on the caller
+/// thread, which owns the GL context. Uploads go in submission order as soon
+/// as each image is decoded, so they overlap with decoding of the rest.
+class AssetLoader {
+public:
+    enum class Kind {
+        TEXTURE,
+        FONT,
+        SOUND,
+        MUSIC
+    };
+
+    /// @brief Asset content in memory (e.g. an asset pack entry), or the file when there is none
+    struct Source {
+        std::string path;
+        std::span<const uint8_t> data; //!< must stay valid while fonts and music use it
+    };
+
+    struct Timing {
+        std::string name;
+        Kind kind = Kind::TEXTURE;
+        size_t bytes = 0;
+        float decode_ms = 0.f;   //!< on a worker thread
+        float upload_ms = 0.f;   //!< on the caller thread, textures only
+        bool loaded = false;
+    };
+
+    struct Report {
+        std::vector<Timing> assets;  //!< in submission order
+        unsigned workers = 0;
+        float wall_ms = 0.f;         //!< whole load() call
+
+        void log() const;
+    };
+
+    void addTexture(const std::string& name, Source source);
+    void addFont(const std::string& name, Source source);
+    void addSound(const std::string& name, Source source);
+    void addMusic(const std::string& name, Source source);
+
+    /*
+     * @brief Decode everything added so far and hand resources over to the managers
+     * @param workers [in] - decoding threads, 0 - hardware concurrency
+     * @return number of assets which failed to load
+     */
+    size_t load(ResourceManager<sf::Texture>& textures,
+                ResourceManager<sf::Font>& fonts,
+                ResourceManager<sf::SoundBuffer>& sounds,
+                ResourceManager<MusicTrack>& music,
+                unsigned workers = 0);
+
+    const Report& report() const;
+
+private:
+    struct Job {
+        Timing timing;
+        Source source;
+        std::unique_ptr<sf::Image> image;
+        std::unique_ptr<sf::Font> font;
+        std::unique_ptr<sf::SoundBuffer> sound;
+        std::unique_ptr<MusicTrack> music;
+        bool done = false;
+    };
+
+    void add(Kind kind, const std::string& name, Source source);
+    void decode(Job& job);
+    void workerLoop();
+
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    std::atomic<size_t> m_next_job = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_done_cv;
+    Report m_report;
+};
+
+#endif // ASSET_LOADER_HPP
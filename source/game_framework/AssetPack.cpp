@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "AssetPack.hpp"
+#include "Logger.hpp"
+
+static_assert(std::endian::native == std::endian::little, "Asset packs are stored little endian");
+
+namespace pack
+{
+
+namespace {
+    uint64_t alignData(uint64_t value) {
+        return (value + DATA_ALIGNMENT - 1) & ~uint64_t(DATA_ALIGNMENT - 1);
+    }
+}
+
+bool AssetPackBuilder::add(const std::string& name, std::vector<uint8_t> data) {
+    for (const auto& file : m_files) {
+        if (file.first == name) {
+            return false;
+        }
+    }
+
+    m_files.emplace_back(name, std::move(data));
+    return true;
+}
+
+std::vector<uint8_t> AssetPackBuilder::build() const {
+    std::vector<const std::pair<std::string, std::vector<uint8_t>>*> files;
+    for (const auto& file : m_files) {
+        files.push_back(&file);
+    }
+    std::sort(files.begin(), files.end(), [](auto a, auto b) { return a->first < b->first; });
+
+    Header header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.entry_count = static_cast<uint32_t>(files.size());
+    header.names_offset = static_cast<uint32_t>(sizeof(Header) + files.size() * sizeof(Entry));
+
+    std::string names;
+    std::vector<Entry> entries(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        entries[i].name_offset = static_cast<uint32_t>(names.size());
+        entries[i].name_size = static_cast<uint32_t>(files[i]->first.size());
+        names += files[i]->first;
+    }
+    header.names_size = static_cast<uint32_t>(names.size());
+
+    // files are laid out in index order, loading them all is one forward pass
+    uint64_t offset = alignData(header.names_offset + names.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        entries[i].data_offset = offset;
+        entries[i].data_size = files[i]->second.size();
+        offset = alignData(offset + entries[i].data_size);
+    }
+
+    std::vector<uint8_t> data(offset, 0);
+    std::memcpy(data.data(), &header, sizeof(header));
+    if (!entries.empty()) {
+        std::memcpy(data.data() + sizeof(Header), entries.data(), entries.size() * sizeof(Entry));
+    }
+    std::memcpy(data.data() + header.names_offset, names.data(), names.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!files[i]->second.empty()) {
+            std::memcpy(data.data() + entries[i].data_offset, files[i]->second.data(), files[i]->second.size());
+        }
+    }
+
+    return data;
+}
+
+} // namespace pack
+
+bool AssetPack::open(const std::string& path) {
+    m_header = nullptr;
+    m_names = nullptr;
+
+    if (!m_file.open(path)) {
+        return false;
+    }
+
+    auto fail = [this, &path](const char* reason) {
+        LOG("ASSET_PACK", ERROR, "%s: %s", path.c_str(), reason);
+        m_file.close();
+        return false;
+    };
+
+    const uint8_t* data = m_file.data();
+    const size_t size = m_file.size();
+    if (size < sizeof(pack::Header)) {
+        return fail("too small");
+    }
+
+    const auto* header = reinterpret_cast<const pack::Header*>(data);
+    if (header->magic != pack::MAGIC || header->version != pack::VERSION) {
+        return fail("not a pack or unsupported version");
+    }
+
+    if (sizeof(pack::Header) + uint64_t(header->entry_count) * sizeof(pack::Entry) > header->names_offset ||
+        uint64_t(header->names_offset) + header->names_size > size) {
+        return fail("broken index");
+    }
+
+    // every entry is checked once here, accessors don't check anything
+    const auto* entries = reinterpret_cast<const pack::Entry*>(data + sizeof(pack::Header));
+    for (uint32_t i = 0; i < header->entry_count; ++i) {
+        if (uint64_t(entries[i].name_offset) + entries[i].name_size > header->names_size ||
+            entries[i].data_offset > size || entries[i].data_size > size - entries[i].data_offset) {
+            return fail("entry out of bounds");
+        }
+    }
+
+    // read the whole pack ahead with one request instead of faulting in page by page
+    m_file.prefetch();
+
+    m_header = header;
+    m_names = reinterpret_cast<const char*>(data + header->names_offset);
+    LOG("ASSET_PACK", INFO, "Opened %s, %u entries, %zu bytes", path.c_str(), header->entry_count, size);
+    return true;
+}
+
+bool AssetPack::isOpen() const {
+    return m_header != nullptr;
+}
+
+std::span<const uint8_t> AssetPack::find(std::string_view name) const {
+    const pack::Entry* entry = findEntry(name);
+    return entry ? entryData(entry - entries()) : std::span<const uint8_t>();
+}
+
+bool AssetPack::contains(std::string_view name) const {
+    // empty files are valid entries, so it isn't the same as find(name).empty()
+    return findEntry(name) != nullptr;
+}
+
+size_t AssetPack::entryCount() const {
+    return m_header ? m_header->entry_count : 0;
+}
+
+std::string_view AssetPack::entryName(size_t index) const {
+    const pack::Entry& entry = entries()[index];
+    return std::string_view(m_names + entry.name_offset, entry.name_size);
+}
+
+std::span<const uint8_t> AssetPack::entryData(size_t index) const {
+    const pack::Entry& entry = entries()[index];
+    return std::span<const uint8_t>(m_file.data() + entry.data_offset, static_cast<size_t>(entry.data_size));
+}
+
+const pack::Entry* AssetPack::entries() const {
+    return reinterpret_cast<const pack::Entry*>(m_file.data() + sizeof(pack::Header));
+}
+
+const pack::Entry* AssetPack::findEntry(std::string_view name) const {
+    if (!m_header) {
+        return nullptr;
+    }
+
+    const pack::Entry* first = entries();
+    const pack::Entry* last = first + m_header->entry_count;
+    auto it = std::lower_bound(first, last, name, [this](const pack::Entry& entry, std::string_view value) {
+        return std::string_view(m_names + entry.name_offset, entry.name_size) < value;
+    });
+
+    return (it != last && entryName(it - first) == name) ? it : nullptr;
+}
@@ -0,0 +1,98 @@
+#ifndef ASSET_PACK_HPP
+#define ASSET_PACK_HPP
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+/*
+ * @namespace pack
+ * @brief Single file asset archive, produced from the res directory by asset-packer
+ *
+ * File layout, little endian:
+ *   Header
+ *   Entry entries[entry_count]   - sorted by name
+ *   char names[names_size]       - not terminated, referenced by offset and size
+ *   file data                    - every file starts 16 bytes aligned
+ */
+namespace pack
+{
+
+constexpr uint32_t MAGIC = 0x4b41504d; // "MPAK"
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t DATA_ALIGNMENT = 16;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t names_offset;
+    uint32_t names_size;
+    uint32_t reserved;
+};
+
+struct Entry {
+    uint32_t name_offset;     //!< relative to the names section
+    uint32_t name_size;
+    uint64_t data_offset;     //!< from the file start
+    uint64_t data_size;
+};
+
+/// @brief Collects files and serialises them to the pack format.
+class AssetPackBuilder {
+public:
+    /*
+     * @brief Add file content
+     * @param name [in] - path relative to the resource root with '/' separators, e.g. "Textures/Mario.png"
+     * @return false if the name is already used
+     */
+    bool add(const std::string& name, std::vector<uint8_t> data);
+
+    std::vector<uint8_t> build() const;
+
+private:
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> m_files;
+};
+
+} // namespace pack
+
+/// @brief Memory mapped asset pack, entries are views into the mapping.
+///
+/// The index is checked once in open(), find() is a binary search by name.
+/// Entry data stays valid while the pack is open, resources decoded lazily
+/// from it (fonts, streamed music) rely on that.
+class AssetPack {
+public:
+    /*
+     * @brief Map the pack and validate its index
+     * @return false if the file is missing or isn't a valid pack
+     */
+    bool open(const std::string& path);
+    bool isOpen() const;
+
+    /*
+     * @brief Get file content
+     * @param name [in] - path relative to the resource root, e.g. "Sounds/coin.wav"
+     * @return empty span if there is no such entry
+     */
+    std::span<const uint8_t> find(std::string_view name) const;
+    bool contains(std::string_view name) const;
+
+    size_t entryCount() const;
+    std::string_view entryName(size_t index) const;
+    std::span<const uint8_t> entryData(size_t index) const;
+
+private:
+    const pack::Entry* entries() const;
+    const pack::Entry* findEntry(std::string_view name) const;
+
+    MappedFile m_file;
+    const pack::Header* m_header = nullptr;
+    const char* m_names = nullptr;
+};
+
+#endif // ASSET_PACK_HPP
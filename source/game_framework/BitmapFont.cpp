@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <limits>
+
+#include "BitmapFont.hpp"
+#include "Logger.hpp"
+#include "Renderer.hpp"
+
+namespace {
+    constexpr unsigned ATLAS_WIDTH = 512;
+    constexpr int GLYPH_PADDING = 1; //!< transparent border kept around glyphs for filtering
+
+    uint32_t kerningKey(char32_t first, char32_t second) {
+        return (static_cast<uint32_t>(first) << 8) | static_cast<uint32_t>(second);
+    }
+}
+
+std::map<BitmapFont::Key, std::unique_ptr<BitmapFont>> BitmapFont::s_fonts;
+//---------------------------------------------------------------------------
+//! BitmapFont
+//---------------------------------------------------------------------------
+const BitmapFont& BitmapFont::get(const sf::Font& font, unsigned size, uint32_t style) {
+    const bool bold = (style & sf::Text::Bold) != 0;
+    Key key(&font, size, bold);
+
+    auto it = s_fonts.find(key);
+    if (it != s_fonts.end()) {
+        return *it->second;
+    }
+
+    auto baked = std::make_unique<BitmapFont>();
+    baked->bake(font, size, bold);
+    return *(s_fonts[key] = std::move(baked));
+}
+
+bool BitmapFont::bake(const sf::Font& font, unsigned size, bool bold) {
+    m_size = size;
+    m_line_spacing = font.getLineSpacing(size);
+    m_glyphs.assign(LAST_CHAR - FIRST_CHAR + 1, Glyph());
+    m_kerning.clear();
+
+    // rasterise the whole set first, the font page only grows meanwhile
+    std::vector<sf::Glyph> source;
+    source.reserve(m_glyphs.size());
+    for (char32_t code = FIRST_CHAR; code <= LAST_CHAR; ++code) {
+        source.push_back(font.getGlyph(code, size, bold));
+    }
+
+    const sf::Image page = font.getTexture(size).copyToImage();
+
+    // shelf packing, glyphs are small and close in height
+    sf::Vector2i pen(0, 0);
+    int shelf_height = 0;
+    std::vector<sf::Vector2i> placement(source.size());
+
+    for (size_t i = 0; i < source.size(); ++i) {
+        const sf::Vector2i glyph_size = source[i].textureRect.size + sf::Vector2i(2 * GLYPH_PADDING, 2 * GLYPH_PADDING);
+
+        if (pen.x + glyph_size.x > static_cast<int>(ATLAS_WIDTH)) {
+            pen = { 0, pen.y + shelf_height };
+            shelf_height = 0;
+        }
+
+        placement[i] = pen;
+        pen.x += glyph_size.x;
+        shelf_height = std::max(shelf_height, glyph_size.y);
+    }
+
+    sf::Image atlas({ ATLAS_WIDTH, static_cast<unsigned>(std::max(1, pen.y + shelf_height)) }, sf::Color::Transparent);
+
+    for (size_t i = 0; i < source.size(); ++i) {
+        const sf::Glyph& glyph = source[i];
+        const sf::Vector2i padding(GLYPH_PADDING, GLYPH_PADDING);
+        const sf::IntRect rect(glyph.textureRect.position - padding, glyph.textureRect.size + padding * 2);
+
+        Glyph& baked = m_glyphs[i];
+        baked.advance = glyph.advance;
+
+        if (glyph.textureRect.size.x <= 0 || glyph.textureRect.size.y <= 0) {
+            continue; // whitespace
+        }
+
+        atlas.copy(page, sf::Vector2u(placement[i]), rect);
+        baked.texture_rect = sf::IntRect(placement[i], rect.size);
+        baked.bounds = sf::FloatRect(glyph.bounds.position - sf::Vector2f(padding),
+                                     glyph.bounds.size + sf::Vector2f(padding * 2));
+    }
+
+    for (char32_t first = FIRST_CHAR; first <= LAST_CHAR; ++first) {
+        for (char32_t second = FIRST_CHAR; second <= LAST_CHAR; ++second) {
+            const float kerning = font.getKerning(first, second, size, bold);
+            if (kerning != 0.f) {
+                m_kerning[kerningKey(first, second)] = kerning;
+            }
+        }
+    }
+
+    if (!m_texture.loadFromImage(atlas)) {
+        LOG("BITMAP_FONT", ERROR, "Failed to create atlas for size %u", size);
+        return false;
+    }
+
+    LOG("BITMAP_FONT", DEBUG, "Baked %ux%u atlas for size %u", atlas.getSize().x, atlas.getSize().y, size);
+    return true;
+}
+
+const BitmapFont::Glyph& BitmapFont::getGlyph(char32_t code) const {
+    if (code < FIRST_CHAR || code > LAST_CHAR) {
+        code = U'?';
+    }
+
+    return m_glyphs[code - FIRST_CHAR];
+}
+
+float BitmapFont::getKerning(char32_t first, char32_t second) const {
+    auto it = m_kerning.find(kerningKey(first, second));
+    return (it != m_kerning.end()) ? it->second : 0.f;
+}
+
+float BitmapFont::getLineSpacing() const {
+    return m_line_spacing;
+}
+
+unsigned BitmapFont::getCharacterSize() const {
+    return m_size;
+}
+
+const sf::Texture& BitmapFont::getTexture() const {
+    return m_texture;
+}
+//---------------------------------------------------------------------------
+//! BitmapText
+//---------------------------------------------------------------------------
+BitmapText::BitmapText(const BitmapFont& font, const std::string& string)
+    : m_font(&font)
+    , m_string(string) {
+}
+
+void BitmapText::setFont(const BitmapFont* font) {
+    if (m_font != font) {
+        m_font = font;
+        m_geometry_dirty = true;
+    }
+}
+
+const BitmapFont* BitmapText::getFont() const {
+    return m_font;
+}
+
+void BitmapText::setString(const std::string& string) {
+    if (m_string != string) {
+        m_string = string;
+        m_geometry_dirty = true;
+    }
+}
+
+const std::string& BitmapText::getString() const {
+    return m_string;
+}
+
+void BitmapText::setFillColor(const sf::Color& color) {
+    m_color = color;
+
+    if (!m_geometry_dirty) {
+        for (auto& vertex : m_vertices) {
+            vertex.color = color;
+        }
+    }
+}
+
+const sf::Color& BitmapText::getFillColor() const {
+    return m_color;
+}
+
+void BitmapText::setPosition(const sf::Vector2f& position) {
+    m_position = position;
+}
+
+const sf::Vector2f& BitmapText::getPosition() const {
+    return m_position;
+}
+
+sf::FloatRect BitmapText::getLocalBounds() const {
+    ensureGeometry();
+    return m_bounds;
+}
+
+sf::FloatRect BitmapText::getGlobalBounds() const {
+    ensureGeometry();
+    return sf::FloatRect(m_bounds.position + m_position, m_bounds.size);
+}
+
+sf::Vector2f BitmapText::findCharacterPos(size_t index) const {
+    if (!m_font) {
+        return {};
+    }
+
+    index = std::min(index, m_string.size());
+    sf::Vector2f pen;
+    char32_t previous = 0;
+
+    for (size_t i = 0; i < index; ++i) {
+        const char32_t code = static_cast<unsigned char>(m_string[i]);
+        pen.x += m_font->getKerning(previous, code);
+        previous = code;
+
+        if (code == U'\n') {
+            pen = { 0.f, pen.y + m_font->getLineSpacing() };
+            continue;
+        }
+
+        pen.x += m_font->getGlyph(code).advance;
+    }
+
+    return pen;
+}
+
+void BitmapText::draw(Renderer* renderer, const sf::RenderStates& states) const {
+    ensureGeometry();
+
+    if (m_vertices.empty()) {
+        return;
+    }
+
+    sf::RenderStates text_states = states;
+    text_states.texture = &m_font->getTexture();
+    text_states.transform.translate(m_position);
+    renderer->drawTriangles(m_vertices.data(), m_vertices.size(), text_states);
+}
+
+void BitmapText::ensureGeometry() const {
+    if (!m_geometry_dirty) {
+        return;
+    }
+
+    m_geometry_dirty = false;
+    m_vertices.clear();
+    m_bounds = sf::FloatRect();
+
+    if (!m_font || m_string.empty()) {
+        return;
+    }
+
+    // same layout as sf::Text: first baseline is one character size down
+    const float size = static_cast<float>(m_font->getCharacterSize());
+    sf::Vector2f pen(0.f, size);
+    sf::Vector2f min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+    sf::Vector2f max(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+    char32_t previous = 0;
+
+    m_vertices.reserve(m_string.size() * 6);
+
+    for (const char character : m_string) {
+        const char32_t code = static_cast<unsigned char>(character);
+        pen.x += m_font->getKerning(previous, code);
+        previous = code;
+
+        if (code == U'\n') {
+            pen = { 0.f, pen.y + m_font->getLineSpacing() };
+            continue;
+        }
+
+        const BitmapFont::Glyph& glyph = m_font->getGlyph(code);
+
+        if (glyph.texture_rect.size.x > 0) {
+            const sf::Vector2f lt = pen + glyph.bounds.position;
+            const sf::Vector2f rb = lt + glyph.bounds.size;
+            const sf::Vector2f uv0(glyph.texture_rect.position);
+            const sf::Vector2f uv1(glyph.texture_rect.position + glyph.texture_rect.size);
+
+            m_vertices.push_back({ lt,               m_color, uv0 });
+            m_vertices.push_back({ { rb.x, lt.y },   m_color, { uv1.x, uv0.y } });
+            m_vertices.push_back({ { lt.x, rb.y },   m_color, { uv0.x, uv1.y } });
+            m_vertices.push_back({ { lt.x, rb.y },   m_color, { uv0.x, uv1.y } });
+            m_vertices.push_back({ { rb.x, lt.y },   m_color, { uv1.x, uv0.y } });
+            m_vertices.push_back({ rb,               m_color, uv1 });
+
+            min = { std::min(min.x, lt.x), std::min(min.y, lt.y) };
+            max = { std::max(max.x, rb.x), std::max(max.y, rb.y) };
+        } else {
+            min = { std::min(min.x, pen.x), std::min(min.y, pen.y) };
+            max = { std::max(max.x, pen.x + glyph.advance), std::max(max.y, pen.y) };
+        }
+
+        pen.x += glyph.advance;
+    }
+
+    if (min.x <= max.x) {
+        m_bounds = sf::FloatRect(min, max - min);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef BITMAP_FONT_HPP
+#define BITMAP_FONT_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+class Renderer;
+
+/// @brief Pre-baked glyph atlas with metrics for one (font, size, style).
+///
+/// Printable ASCII glyphs are rasterised once and packed into an own atlas
+/// texture, so text drawn with it never goes to FreeType or sf::Font pages.
+/// Baked fonts are shared through get(), the sets used by the game are baked
+/// at startup.
+class BitmapFont {
+public:
+    struct Glyph {
+        sf::FloatRect bounds;     //!< quad relative to the pen on the baseline
+        sf::IntRect texture_rect; //!< quad in the atlas
+        float advance = 0.f;
+    };
+
+    static constexpr char32_t FIRST_CHAR = 32;
+    static constexpr char32_t LAST_CHAR = 126;
+
+    /*
+     * @brief Get shared baked font, it's baked on the first request
+     * @param font [in] - source font, must outlive the baked one
+     * @param size [in] - character size
+     * @param style [in] - sf::Text style flags, only Bold affects glyphs
+     */
+    static const BitmapFont& get(const sf::Font& font, unsigned size, uint32_t style = sf::Text::Regular);
+
+    /*
+     * @brief Rasterise printable ASCII set into the atlas
+     * @return false if atlas texture can't be created
+     */
+    bool bake(const sf::Font& font, unsigned size, bool bold);
+
+    /*
+     * @brief Get glyph metrics, characters out of the baked set map to '?'
+     */
+    const Glyph& getGlyph(char32_t code) const;
+    float getKerning(char32_t first, char32_t second) const;
+    float getLineSpacing() const;
+    unsigned getCharacterSize() const;
+    const sf::Texture& getTexture() const;
+
+private:
+    std::vector<Glyph> m_glyphs;
+    std::unordered_map<uint32_t, float> m_kerning; //!< non zero pairs only
+    float m_line_spacing = 0.f;
+    unsigned m_size = 0;
+    sf::Texture m_texture;
+
+    using Key = std::tuple<const sf::Font*, unsigned, bool>;
+    static std::map<Key, std::unique_ptr<BitmapFont>> s_fonts;
+};
+
+/// @brief Lightweight text drawn as batched quads of a BitmapFont.
+///
+/// Mirrors the part of sf::Text interface the game uses. Geometry is built
+/// lazily after the string or font change, color change only patches vertices.
+class BitmapText {
+public:
+    BitmapText() = default;
+    explicit BitmapText(const BitmapFont& font, const std::string& string = "");
+
+    void setFont(const BitmapFont* font);
+    const BitmapFont* getFont() const;
+    void setString(const std::string& string);
+    const std::string& getString() const;
+    void setFillColor(const sf::Color& color);
+    const sf::Color& getFillColor() const;
+    void setPosition(const sf::Vector2f& position);
+    const sf::Vector2f& getPosition() const;
+
+    sf::FloatRect getLocalBounds() const;
+    sf::FloatRect getGlobalBounds() const;
+
+    /*
+     * @brief Get pen position before the character with given index, in local coordinates
+     */
+    sf::Vector2f findCharacterPos(size_t index) const;
+
+    void draw(Renderer* renderer, const sf::RenderStates& states = sf::RenderStates::Default) const;
+
+private:
+    void ensureGeometry() const;
+
+    const BitmapFont* m_font = nullptr;
+    std::string m_string;
+    sf::Color m_color = sf::Color::White;
+    sf::Vector2f m_position;
+
+    mutable std::vector<sf::Vertex> m_vertices;
+    mutable sf::FloatRect m_bounds;
+    mutable bool m_geometry_dirty = true;
+};
+
+#endif // BITMAP_FONT_HPP
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <SFML/OpenGL.hpp>
+
+#include "FrameCapture.hpp"
+#include "Logger.hpp"
+#include "SoftwareRenderBackend.hpp"
+
+namespace {
+    float elapsedMs(std::chrono::steady_clock::time_point from) {
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - from).count();
+    }
+
+    // the pattern is passed to snprintf, so it must have exactly one integer conversion
+    bool isFramePattern(const std::string& pattern) {
+        int conversions = 0;
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            if (pattern[i] != '%') {
+                continue;
+            }
+            if (++i < pattern.size() && pattern[i] == '%') {
+                continue;
+            }
+
+            i = pattern.find_first_not_of("-+ #0123456789", i);
+            if (i == std::string::npos || std::string("diu").find(pattern[i]) == std::string::npos) {
+                return false;
+            }
+            ++conversions;
+        }
+        return conversions == 1;
+    }
+
+    std::string framePattern(const std::string& pattern) {
+        if (isFramePattern(pattern)) {
+            return pattern;
+        }
+
+        std::string escaped;
+        for (char chr : pattern) {
+            escaped += (chr == '%') ? "%%" : std::string(1, chr);
+        }
+        LOG("CAPTURE", WARNING, "Capture path %s has no frame number, it's appended", pattern.c_str());
+        return escaped + "_%05d.png";
+    }
+}
+
+FrameCapture::FrameCapture(const std::string& path_pattern, unsigned every_nth, size_t buffers, unsigned workers)
+    : m_path_pattern(framePattern(path_pattern))
+    , m_every_nth(std::max(1u, every_nth))
+    , m_buffers(std::max<size_t>(1, buffers)) {
+
+    for (size_t i = 0; i < m_buffers.size(); ++i) {
+        m_free.push_back(i);
+    }
+
+    if (!workers) {
+        // hardware_concurrency() may be 0 if unknown
+        workers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    for (unsigned i = 0; i < workers; ++i) {
+        m_workers.emplace_back(&FrameCapture::workerLoop, this);
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    flush();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_queue_cv.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+bool FrameCapture::nextFrame() {
+    return (m_frame++ % m_every_nth) == 0;
+}
+
+bool FrameCapture::capture(const uint8_t* rgba, const sf::Vector2u& size) {
+    const auto start = Clock::now();
+    const size_t index = acquire();
+    if (index == NO_BUFFER) {
+        return false;
+    }
+
+    Buffer& buffer = prepare(index, size);
+    std::memcpy(buffer.pixels.data(), rgba, buffer.pixels.size());
+    submit(index, start);
+    return true;
+}
+
+bool FrameCapture::capture(sf::RenderWindow& window) {
+    // a buffer is taken first, so the GPU readback is skipped for dropped frames
+    const auto start = Clock::now();
+    const size_t index = acquire();
+    if (index == NO_BUFFER) {
+        return false;
+    }
+
+    if (!readFramebuffer(index, window)) {
+        release(index);
+        return false;
+    }
+
+    submit(index, start);
+    return true;
+}
+
+bool FrameCapture::capture(sf::RenderTexture& target) {
+    const auto start = Clock::now();
+    const size_t index = acquire();
+    if (index == NO_BUFFER) {
+        return false;
+    }
+
+    if (!readFramebuffer(index, target)) {
+        release(index);
+        return false;
+    }
+
+    submit(index, start);
+    return true;
+}
+
+bool FrameCapture::capture(const SoftwareRenderBackend& backend) {
+    return capture(reinterpret_cast<const uint8_t*>(backend.getPixels()), backend.getSize());
+}
+
+size_t FrameCapture::acquire() {
+    ++m_capture_frame; // dropped frames leave gaps in the numbering
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_free.empty()) {
+        ++m_stats.dropped;
+        return NO_BUFFER;
+    }
+
+    const size_t index = m_free.back();
+    m_free.pop_back();
+    return index;
+}
+
+void FrameCapture::release(size_t index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free.push_back(index);
+}
+
+FrameCapture::Buffer& FrameCapture::prepare(size_t index, const sf::Vector2u& size) {
+    // buffers keep their capacity, allocation happens only for the first frames or on resize
+    Buffer& buffer = m_buffers[index];
+    buffer.pixels.resize(size_t(size.x) * size.y * 4);
+    buffer.size = size;
+    return buffer;
+}
+
+bool FrameCapture::readFramebuffer(size_t index, sf::RenderTarget& target) {
+    if (!target.setActive(true)) {
+        LOG("CAPTURE", ERROR, "Failed to activate render target for capture");
+        return false;
+    }
+
+    // read straight into the buffer, no sf::Image is created per frame
+    const sf::Vector2u size = target.getSize();
+    Buffer& buffer = prepare(index, size);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, GLsizei(size.x), GLsizei(size.y), GL_RGBA, GL_UNSIGNED_BYTE, buffer.pixels.data());
+
+    // OpenGL rows go bottom up
+    const size_t stride = size_t(size.x) * 4;
+    for (size_t top = 0, bottom = size.y; top + 1 < bottom; ++top, --bottom) {
+        std::swap_ranges(buffer.pixels.begin() + top * stride, buffer.pixels.begin() + (top + 1) * stride,
+                         buffer.pixels.begin() + (bottom - 1) * stride);
+    }
+    return true;
+}
+
+void FrameCapture::submit(size_t index, Clock::time_point start) {
+    Buffer& buffer = m_buffers[index];
+    buffer.frame = m_capture_frame - 1;
+    buffer.captured = start;
+
+    const float copy_ms = elapsedMs(start);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(index);
+        m_stats.queue_peak = std::max(m_stats.queue_peak, m_queue.size());
+        ++m_stats.captured;
+        m_copy_ms_total += copy_ms;
+        m_stats.copy_ms_max = std::max(m_stats.copy_ms_max, copy_ms);
+    }
+    m_queue_cv.notify_one();
+}
+
+void FrameCapture::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle_cv.wait(lock, [this] { return m_queue.empty() && !m_encoding; });
+}
+
+FrameCapture::Stats FrameCapture::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.copy_ms_avg = stats.captured ? float(m_copy_ms_total / stats.captured) : 0.f;
+    stats.latency_ms_avg = stats.written ? float(m_latency_ms_total / stats.written) : 0.f;
+    return stats;
+}
+
+void FrameCapture::logStats() const {
+    const Stats stats = getStats();
+    LOG("CAPTURE", INFO, "Frames captured %zu, written %zu, dropped %zu, failed %zu, queue peak %zu/%zu",
+        stats.captured, stats.written, stats.dropped, stats.failed, stats.queue_peak, m_buffers.size());
+    LOG("CAPTURE", INFO, "Copy avg/max %.2f/%.2f ms, latency avg/max %.1f/%.1f ms",
+        stats.copy_ms_avg, stats.copy_ms_max, stats.latency_ms_avg, stats.latency_ms_max);
+}
+
+void FrameCapture::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_queue_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            return;
+        }
+
+        const size_t index = m_queue.front();
+        m_queue.pop_front();
+        ++m_encoding;
+
+        lock.unlock();
+        encode(m_buffers[index]);
+        lock.lock();
+
+        m_free.push_back(index);
+        --m_encoding;
+        if (m_queue.empty() && !m_encoding) {
+            m_idle_cv.notify_all();
+        }
+    }
+}
+
+void FrameCapture::encode(Buffer& buffer) {
+    char path[512];
+    std::snprintf(path, sizeof(path), m_path_pattern.c_str(), (int)buffer.frame);
+
+    const sf::Image image(buffer.size, buffer.pixels.data());
+    const bool saved = image.saveToFile(path);
+    const float latency = elapsedMs(buffer.captured);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (saved) {
+        ++m_stats.written;
+        m_latency_ms_total += latency;
+        m_stats.latency_ms_max = std::max(m_stats.latency_ms_max, latency);
+    } else {
+        ++m_stats.failed;
+        LOG("CAPTURE", ERROR, "Failed to write frame %s", path);
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+class SoftwareRenderBackend;
+
+/// @brief Dumps every Nth frame to a numbered PNG sequence.
+///
+/// The caller thread only copies pixels into one of preallocated buffers,
+/// compression and file writes run on worker threads. The number of buffers
+/// bounds the queue: when all of them wait for the encoder the frame is
+/// dropped, the caller is never blocked.
+class FrameCapture {
+public:
+    struct Stats {
+        size_t captured = 0;       //!< frames copied to a buffer
+        size_t written = 0;
+        size_t dropped = 0;        //!< no free buffer, encoder fell behind
+        size_t failed = 0;         //!< encoder or file errors
+        size_t queue_peak = 0;
+        float copy_ms_avg = 0.f;   //!< time spent on the caller thread, readback included
+        float copy_ms_max = 0.f;
+        float latency_ms_avg = 0.f; //!< from copy to file written
+        float latency_ms_max = 0.f;
+    };
+
+    /*
+     * @param path_pattern [in] - printf pattern with one integer for frame number, e.g. "capture/frame_%05d.png",
+     *                             other patterns get the number appended
+     * @param every_nth [in] - capture one frame of every N
+     * @param buffers [in] - preallocated frame buffers, also the max queue depth
+     * @param workers [in] - encoder threads, 0 - hardware concurrency - 1
+     */
+    FrameCapture(const std::string& path_pattern, unsigned every_nth = 1, size_t buffers = 8, unsigned workers = 0);
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    /*
+     * @brief Count the frame, true if it has to be captured
+     * @note Call once per frame before one of capture() calls, the readback is skipped for others
+     */
+    bool nextFrame();
+
+    /*
+     * @brief Copy frame from a source, returns false if the frame was dropped
+     */
+    bool capture(const uint8_t* rgba, const sf::Vector2u& size);
+    bool capture(sf::RenderWindow& window);
+    bool capture(sf::RenderTexture& target);
+    bool capture(const SoftwareRenderBackend& backend);
+
+    /*
+     * @brief Wait until all queued frames are written
+     */
+    void flush();
+
+    Stats getStats() const;
+    void logStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Buffer {
+        std::vector<uint8_t> pixels;
+        sf::Vector2u size;
+        size_t frame = 0;
+        Clock::time_point captured;
+    };
+
+    static constexpr size_t NO_BUFFER = size_t(-1);
+
+    size_t acquire();
+    void release(size_t index);
+    Buffer& prepare(size_t index, const sf::Vector2u& size);
+    bool readFramebuffer(size_t index, sf::RenderTarget& target);
+    void submit(size_t index, Clock::time_point start);
+    void workerLoop();
+    void encode(Buffer& buffer);
+
+    std::string m_path_pattern;
+    unsigned m_every_nth;
+    size_t m_frame = 0;
+    size_t m_capture_frame = 0;
+
+    std::vector<Buffer> m_buffers;
+    std::vector<size_t> m_free;   //!< guarded by m_mutex
+    std::deque<size_t> m_queue;   //!< guarded by m_mutex
+    size_t m_encoding = 0;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queue_cv;
+    std::condition_variable m_idle_cv;
+    std::vector<std::thread> m_workers;
+    bool m_stop = false;
+
+    Stats m_stats;
+    double m_copy_ms_total = 0.0;
+    double m_latency_ms_total = 0.0;
+};
+
+#endif // FRAME_CAPTURE_HPP
@@ -78,9 +78,27 @@ void GameObject::setProperty(const std::string& name, const Property& property)
 
 Property GameObject::getProperty(const std::string& name) const {
     onPropertyGet(name);
-    return const_cast<GameObject*>(this)->m_properties[name];
+
+    auto it = m_properties.find(name);
+    if (it != m_properties.end()) {
+        return it->second;
+    }
+
+    if (m_property_template) {
+        auto shared = m_property_template->find(name);
+        if (shared != m_property_template->end()) {
+            return shared->second;
+        }
+    }
+
+    return Property();
 };
 
+void GameObject::setPropertyTemplate(std::shared_ptr<const PropertyMap> properties) {
+    m_property_template = std::move(properties);
+    onPropertyTemplateSet();
+}
+
 void GameObject::disable() {
     m_enabled = false;
 }
@@ -137,14 +155,14 @@ GameObject::~GameObject() {
     }
 }
 
-void GameObject::draw(sf::RenderWindow* window) {
+void GameObject::draw(Renderer* renderer) {
     if (!isVisible()) {
         return;
     }
 
     for (auto& obj : m_childObjects) {
         if (obj->isVisible()) {
-            obj->draw(window);
+            obj->draw(renderer);
         }
     }
 }
@@ -180,6 +198,21 @@ void GameObject::onPropertySet(const std::string& name) {
 void GameObject::onPropertyGet(const std::string& name) const {
 }
 
+void GameObject::onPropertyTemplateSet() {
+    // only the keys handled by onPropertySet(), the rest is read on demand
+    const Property x = getProperty("x");
+    const Property y = getProperty("y");
+    if (x.isValid() || y.isValid()) {
+        setPosition(x.isValid() ? x.asFloat() : getPosition().x,
+                    y.isValid() ? y.asFloat() : getPosition().y);
+    }
+
+    const Property name = getProperty("name");
+    if (name.isValid()) {
+        setName(name.asString());
+    }
+}
+
 void GameObject::moveToBack() {
     if (!getParent()) {
         // add warning
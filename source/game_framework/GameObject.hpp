@@ -4,15 +4,20 @@
 #include <functional>
 #include <list>
 #include <map>
+#include <memory>
 
 #include "Property.hpp"
 #include "Rect.hpp"
 #include <RTIIX.hpp>
 #include "Vector.hpp"
 
+class Renderer;
+
 class GameObject : public TypeIdentifiable {
 
 public:
+    using PropertyMap = std::map<std::string, Property>;
+
     GameObject() = default;
     virtual ~GameObject();
 
@@ -22,6 +27,13 @@ public:
     void setProperty(const std::string& name, const Property& property);
     Property getProperty(const std::string& name) const;
 
+    /*
+     * @brief Share read-only properties between objects created from the same template
+     * @param properties [in] - typed properties, setProperty() overrides them per object
+     * @note onPropertySet() isn't called for every template key, see onPropertyTemplateSet()
+     */
+    void setPropertyTemplate(std::shared_ptr<const PropertyMap> properties);
+
     // hierarchy
     void setParent(GameObject* game_object);
     GameObject* getParent() const;
@@ -101,7 +113,7 @@ public:
     void hide();
     void show();
     bool isVisible() const;
-    virtual void draw(sf::RenderWindow* window);
+    virtual void draw(Renderer* renderer);
 
     // collisions
     virtual Rect getBounds() const;
@@ -113,11 +125,13 @@ protected:
     virtual void onParentSet() {};
     virtual void onPropertySet(const std::string& name);
     virtual void onPropertyGet(const std::string& name) const;
+    virtual void onPropertyTemplateSet();
     virtual void onPositionChanged(const Vector& new_pos, const Vector& old_pos) {};
 
 private:
     std::string m_name;
-    std::map<std::string, Property> m_properties;
+    PropertyMap m_properties;                               //!< own properties, override the template
+    std::shared_ptr<const PropertyMap> m_property_template;
     GameObject* m_parentObject = nullptr;
     std::list<GameObject*> m_childObjects;
     bool m_enabled = true;
@@ -0,0 +1,492 @@
+#include <bit>
+#include <charconv>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <map>
+
+#include "tinyxml2.h"
+
+#include "Format.hpp"
+#include "LevelFormat.hpp"
+#include "Logger.hpp"
+
+static_assert(std::endian::native == std::endian::little, "Compiled levels are stored little endian");
+
+namespace level
+{
+
+namespace {
+    uint32_t align4(size_t value) {
+        return static_cast<uint32_t>((value + 3) & ~size_t(3));
+    }
+
+    float toFloat(const char* value) {
+        return value ? utils::toFloat(value) : 0.f;
+    }
+
+    int toInt(const char* value) {
+        return value ? utils::toInt(value) : 0;
+    }
+
+    struct Value {
+        PropertyType type = PropertyType::STRING;
+        int int_value = 0;
+        float float_value = 0.f;
+        bool bool_value = false;
+        std::string string_value;
+    };
+
+    Value makeFloat(float value) {
+        Value result;
+        result.type = PropertyType::FLOAT;
+        result.float_value = value;
+        return result;
+    }
+
+    Value makeString(const char* value) {
+        Value result;
+        result.type = PropertyType::STRING;
+        result.string_value = value ? value : "";
+        return result;
+    }
+
+    Value parseValue(tinyxml2::XMLElement* property) {
+        const char* type = property->Attribute("type");
+        const char* text = property->Attribute("value");
+        const std::string value = text ? text : "";
+
+        using utils::strHash;
+        Value result;
+
+        switch (type ? strHash(type) : strHash("string")) {
+        case strHash("int"):
+            result.type = PropertyType::INT;
+            result.int_value = utils::toInt(value);
+            break;
+        case strHash("float"):
+            result.type = PropertyType::FLOAT;
+            result.float_value = utils::toFloat(value);
+            break;
+        case strHash("bool"):
+            result.type = PropertyType::BOOL;
+            result.bool_value = utils::toBool(value);
+            break;
+        default:
+            result.string_value = value;
+            break;
+        }
+
+        return result;
+    }
+
+    // properties keyed by name, so objects get them sorted and the last duplicate wins
+    std::map<std::string, Value> parseObjectProperties(tinyxml2::XMLElement* object) {
+        std::map<std::string, Value> parsed;
+
+        // common properties
+        parsed["x"] = makeFloat(toFloat(object->Attribute("x")));
+        parsed["y"] = makeFloat(toFloat(object->Attribute("y")));
+        parsed["width"] = makeFloat(toFloat(object->Attribute("width")));
+        parsed["height"] = makeFloat(toFloat(object->Attribute("height")));
+        parsed["name"] = makeString(object->Attribute("name"));
+
+        // specific properties
+        tinyxml2::XMLElement* properties = object->FirstChildElement("properties");
+        if (properties) {
+            for (auto property = properties->FirstChildElement("property"); property; property = property->NextSiblingElement()) {
+                const char* name = property->Attribute("name");
+                if (name) {
+                    parsed[name] = parseValue(property);
+                }
+            }
+        }
+
+        // text element
+        tinyxml2::XMLElement* text = object->FirstChildElement("text");
+        if (text && text->FirstChild()) {
+            parsed["text"] = makeString(text->FirstChild()->Value());
+        }
+
+        return parsed;
+    }
+
+    bool fail(std::string* error, const std::string& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    }
+}
+//---------------------------------------------------------------------------
+//! LevelView
+//---------------------------------------------------------------------------
+bool LevelView::open(const uint8_t* data, size_t size) {
+    m_data = nullptr;
+    m_size = 0;
+
+    if (!data || size < sizeof(Header) || reinterpret_cast<uintptr_t>(data) % alignof(Header)) {
+        return false;
+    }
+
+    const Header& header = *reinterpret_cast<const Header*>(data);
+    if (header.magic != MAGIC || header.version != VERSION) {
+        return false;
+    }
+
+    auto fits = [size](uint32_t offset, uint64_t bytes) {
+        return offset % 4 == 0 && uint64_t(offset) + bytes <= size;
+    };
+
+    if (!fits(header.tiles_offset, uint64_t(header.width) * header.height * sizeof(uint16_t)) ||
+        !fits(header.types_offset, uint64_t(header.type_count) * sizeof(uint32_t)) ||
+        !fits(header.objects_offset, uint64_t(header.object_count) * sizeof(ObjectRecord)) ||
+        !fits(header.properties_offset, uint64_t(header.property_count) * sizeof(PropertyRecord)) ||
+        !fits(header.strings_offset, header.strings_size)) {
+        return false;
+    }
+
+    // every string reference is checked once here, accessors don't check anything
+    const char* strings = reinterpret_cast<const char*>(data + header.strings_offset);
+    if (!header.strings_size || strings[header.strings_size - 1] != '\0') {
+        return false;
+    }
+
+    const uint32_t* types = reinterpret_cast<const uint32_t*>(data + header.types_offset);
+    for (uint32_t i = 0; i < header.type_count; ++i) {
+        if (types[i] >= header.strings_size) {
+            return false;
+        }
+    }
+
+    const ObjectRecord* objects = reinterpret_cast<const ObjectRecord*>(data + header.objects_offset);
+    for (uint32_t i = 0; i < header.object_count; ++i) {
+        if (objects[i].type >= header.type_count ||
+            uint64_t(objects[i].first_property) + objects[i].property_count > header.property_count) {
+            return false;
+        }
+    }
+
+    const PropertyRecord* properties = reinterpret_cast<const PropertyRecord*>(data + header.properties_offset);
+    for (uint32_t i = 0; i < header.property_count; ++i) {
+        if (properties[i].name >= header.strings_size ||
+            properties[i].type > PropertyType::STRING ||
+            (properties[i].type == PropertyType::STRING && properties[i].string_value >= header.strings_size)) {
+            return false;
+        }
+    }
+
+    m_data = data;
+    m_size = size;
+    return true;
+}
+
+bool LevelView::isOpen() const {
+    return m_data != nullptr;
+}
+
+const Header& LevelView::header() const {
+    return *section<Header>(0);
+}
+
+const uint16_t* LevelView::tiles() const {
+    return section<uint16_t>(header().tiles_offset);
+}
+
+size_t LevelView::tileCount() const {
+    return size_t(header().width) * header().height;
+}
+
+std::string_view LevelView::typeName(uint32_t type) const {
+    return string(section<uint32_t>(header().types_offset)[type]);
+}
+
+uint32_t LevelView::typeCount() const {
+    return header().type_count;
+}
+
+const ObjectRecord* LevelView::objects() const {
+    return section<ObjectRecord>(header().objects_offset);
+}
+
+uint32_t LevelView::objectCount() const {
+    return header().object_count;
+}
+
+const PropertyRecord* LevelView::properties(const ObjectRecord& object) const {
+    return section<PropertyRecord>(header().properties_offset) + object.first_property;
+}
+
+std::string_view LevelView::string(uint32_t offset) const {
+    return std::string_view(section<char>(header().strings_offset + offset));
+}
+
+Property LevelView::toProperty(const PropertyRecord& property) const {
+    switch (property.type) {
+    case PropertyType::INT:
+        return Property(static_cast<int>(property.int_value));
+    case PropertyType::FLOAT:
+        return Property(property.float_value);
+    case PropertyType::BOOL:
+        return Property(property.int_value != 0);
+    default:
+        return Property(std::string(string(property.string_value)));
+    }
+}
+//---------------------------------------------------------------------------
+//! LevelBuilder
+//---------------------------------------------------------------------------
+void LevelBuilder::setMap(uint32_t width, uint32_t height, uint32_t tile_width, uint32_t tile_height) {
+    m_header.width = width;
+    m_header.height = height;
+    m_header.tile_width = tile_width;
+    m_header.tile_height = tile_height;
+}
+
+void LevelBuilder::setTiles(std::vector<uint16_t> tiles) {
+    m_tiles = std::move(tiles);
+}
+
+void LevelBuilder::beginObject(const std::string& type) {
+    auto it = m_type_ids.find(type);
+    if (it == m_type_ids.end()) {
+        it = m_type_ids.emplace(type, static_cast<uint32_t>(m_types.size())).first;
+        m_types.push_back(intern(type));
+    }
+
+    ObjectRecord object;
+    object.type = it->second;
+    object.first_property = static_cast<uint32_t>(m_properties.size());
+    object.property_count = 0;
+    m_objects.push_back(object);
+}
+
+void LevelBuilder::addInt(const std::string& name, int value) {
+    addProperty(name, PropertyType::INT).int_value = value;
+}
+
+void LevelBuilder::addFloat(const std::string& name, float value) {
+    addProperty(name, PropertyType::FLOAT).float_value = value;
+}
+
+void LevelBuilder::addBool(const std::string& name, bool value) {
+    addProperty(name, PropertyType::BOOL).int_value = value ? 1 : 0;
+}
+
+void LevelBuilder::addString(const std::string& name, const std::string& value) {
+    const uint32_t offset = intern(value);
+    addProperty(name, PropertyType::STRING).string_value = offset;
+}
+
+PropertyRecord& LevelBuilder::addProperty(const std::string& name, PropertyType type) {
+    assert(!m_objects.empty()); // beginObject() first
+
+    PropertyRecord property = {};
+    property.name = intern(name);
+    property.type = type;
+    m_properties.push_back(property);
+    ++m_objects.back().property_count;
+    return m_properties.back();
+}
+
+uint32_t LevelBuilder::intern(const std::string& string) {
+    auto it = m_string_offsets.find(string);
+    if (it != m_string_offsets.end()) {
+        return it->second;
+    }
+
+    const uint32_t offset = static_cast<uint32_t>(m_strings.size());
+    m_strings.append(string);
+    m_strings.push_back('\0');
+    m_string_offsets.emplace(string, offset);
+    return offset;
+}
+
+std::vector<uint8_t> LevelBuilder::build() const {
+    Header header = m_header;
+    header.magic = MAGIC;
+    header.version = VERSION;
+
+    std::string strings = m_strings;
+    if (strings.empty()) {
+        strings.push_back('\0');
+    }
+
+    header.tiles_offset = align4(sizeof(Header));
+    header.types_offset = align4(header.tiles_offset + m_tiles.size() * sizeof(uint16_t));
+    header.type_count = static_cast<uint32_t>(m_types.size());
+    header.objects_offset = align4(header.types_offset + m_types.size() * sizeof(uint32_t));
+    header.object_count = static_cast<uint32_t>(m_objects.size());
+    header.properties_offset = align4(header.objects_offset + m_objects.size() * sizeof(ObjectRecord));
+    header.property_count = static_cast<uint32_t>(m_properties.size());
+    header.strings_offset = align4(header.properties_offset + m_properties.size() * sizeof(PropertyRecord));
+    header.strings_size = static_cast<uint32_t>(strings.size());
+
+    std::vector<uint8_t> data(header.strings_offset + strings.size(), 0);
+    auto write = [&data](uint32_t offset, const void* source, size_t bytes) {
+        if (bytes) {
+            std::memcpy(data.data() + offset, source, bytes);
+        }
+    };
+
+    write(0, &header, sizeof(header));
+    write(header.tiles_offset, m_tiles.data(), m_tiles.size() * sizeof(uint16_t));
+    write(header.types_offset, m_types.data(), m_types.size() * sizeof(uint32_t));
+    write(header.objects_offset, m_objects.data(), m_objects.size() * sizeof(ObjectRecord));
+    write(header.properties_offset, m_properties.data(), m_properties.size() * sizeof(PropertyRecord));
+    write(header.strings_offset, strings.data(), strings.size());
+    return data;
+}
+//---------------------------------------------------------------------------
+//! Tiled map conversion
+//---------------------------------------------------------------------------
+bool compileTmx(const std::string& tmx_path, std::vector<uint8_t>& output, std::string* error) {
+    tinyxml2::XMLDocument document;
+    if (document.LoadFile(tmx_path.c_str()) != tinyxml2::XML_SUCCESS) {
+        return fail(error, "can't load " + tmx_path);
+    }
+
+    tinyxml2::XMLElement* root_element = document.FirstChildElement("map");
+    if (!root_element) {
+        return fail(error, "no map element");
+    }
+
+    const int width = toInt(root_element->Attribute("width"));
+    const int height = toInt(root_element->Attribute("height"));
+    if (width <= 0 || height <= 0) {
+        return fail(error, "invalid map size");
+    }
+
+    LevelBuilder builder;
+    builder.setMap(width, height,
+                   toInt(root_element->Attribute("tilewidth")),
+                   toInt(root_element->Attribute("tileheight")));
+
+    tinyxml2::XMLElement* layer = root_element->FirstChildElement("layer");
+    tinyxml2::XMLElement* data = layer ? layer->FirstChildElement("data") : nullptr;
+    if (!data || !data->GetText()) {
+        return fail(error, "no tile layer data");
+    }
+
+    // parsed in place from the document buffer straight into the tile array
+    std::vector<uint16_t> tiles(size_t(width) * height);
+    if (!parseTileCsv(data->GetText(), tiles.data(), tiles.size(), error)) {
+        return false;
+    }
+    builder.setTiles(std::move(tiles));
+
+    tinyxml2::XMLElement* objects = root_element->FirstChildElement("objectgroup");
+    if (objects) {
+        for (auto object = objects->FirstChildElement("object"); object; object = object->NextSiblingElement()) {
+            // objects without type may still be created from a prefab
+            const char* type = object->Attribute("type");
+            builder.beginObject(type ? type : "");
+            for (const auto& [name, value] : parseObjectProperties(object)) {
+                switch (value.type) {
+                case PropertyType::INT:
+                    builder.addInt(name, value.int_value);
+                    break;
+                case PropertyType::FLOAT:
+                    builder.addFloat(name, value.float_value);
+                    break;
+                case PropertyType::BOOL:
+                    builder.addBool(name, value.bool_value);
+                    break;
+                default:
+                    builder.addString(name, value.string_value);
+                    break;
+                }
+            }
+        }
+    }
+
+    output = builder.build();
+    return true;
+}
+
+bool parseTileCsv(std::string_view csv, uint16_t* tiles, size_t count, std::string* error) {
+    // Tiled keeps flip flags in the top bits of a tile id
+    constexpr uint32_t FLIP_FLAGS = 0xE0000000;
+
+    const char* chr = csv.data();
+    const char* const end = chr + csv.size();
+    size_t parsed = 0;
+
+    while (true) {
+        while (chr != end && (*chr < '0' || *chr > '9')) {
+            ++chr;
+        }
+
+        if (chr == end) {
+            break;
+        }
+
+        uint32_t value = 0;
+        const auto [next, ec] = std::from_chars(chr, end, value);
+        if (ec != std::errc()) {
+            return fail(error, "invalid tile id");
+        }
+
+        value &= ~FLIP_FLAGS;
+        if (value > UINT16_MAX) {
+            return fail(error, "tile id " + std::to_string(value) + " is out of range");
+        }
+
+        if (parsed == count) {
+            return fail(error, "more tiles than the map size");
+        }
+
+        tiles[parsed++] = static_cast<uint16_t>(value);
+        chr = next;
+    }
+
+    if (parsed != count) {
+        return fail(error, "fewer tiles than the map size");
+    }
+
+    return true;
+}
+
+std::string compiledPath(const std::string& tmx_path) {
+    return std::filesystem::path(tmx_path).replace_extension(COMPILED_EXTENSION).string();
+}
+//---------------------------------------------------------------------------
+//! LevelFile
+//---------------------------------------------------------------------------
+bool LevelFile::load(const std::string& tmx_path) {
+    m_file.close();
+    m_buffer.clear();
+
+    const std::string compiled_path = compiledPath(tmx_path);
+    std::error_code ec;
+    const auto compiled_time = std::filesystem::last_write_time(compiled_path, ec);
+    const bool has_compiled = !ec;
+    const auto source_time = std::filesystem::last_write_time(tmx_path, ec);
+    const bool source_is_newer = !ec && has_compiled && source_time > compiled_time;
+
+    if (has_compiled && !source_is_newer && m_file.open(compiled_path)) {
+        if (m_view.open(m_file.data(), m_file.size())) {
+            return true;
+        }
+        LOG("LEVEL", WARNING, "%s is invalid or outdated, loading %s", compiled_path.c_str(), tmx_path.c_str());
+        m_file.close();
+    }
+
+    std::string error;
+    if (!compileTmx(tmx_path, m_buffer, &error)) {
+        LOG("LEVEL", ERROR, "Failed to load %s: %s", tmx_path.c_str(), error.c_str());
+        return false;
+    }
+
+    return m_view.open(m_buffer.data(), m_buffer.size());
+}
+
+const LevelView& LevelFile::view() const {
+    return m_view;
+}
+
+bool LevelFile::isCompiled() const {
+    return m_file.isOpen();
+}
+
+} // namespace level
@@ -0,0 +1,181 @@
+#ifndef LEVEL_FORMAT_HPP
+#define LEVEL_FORMAT_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "Property.hpp"
+
+/*
+ * @namespace level
+ * @brief Compiled level format, produced from Tiled .tmx maps by level-compiler
+ *
+ * File layout, all sections are 4 bytes aligned, little endian:
+ *   Header
+ *   uint16_t tiles[width * height]       - tile ids, 0 - empty
+ *   uint32_t types[type_count]           - object type names, string pool offsets
+ *   ObjectRecord objects[object_count]
+ *   PropertyRecord properties[property_count] - grouped per object, sorted by name
+ *   char strings[strings_size]           - zero terminated strings
+ */
+namespace level
+{
+
+constexpr uint32_t MAGIC = 0x4c564c4d; // "MLVL"
+constexpr uint32_t VERSION = 1;
+constexpr const char* COMPILED_EXTENSION = ".lvl";
+
+enum class PropertyType : uint8_t {
+    INT    = 0,
+    FLOAT  = 1,
+    BOOL   = 2,
+    STRING = 3
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tile_width;
+    uint32_t tile_height;
+    uint32_t tiles_offset;
+    uint32_t types_offset;
+    uint32_t type_count;
+    uint32_t objects_offset;
+    uint32_t object_count;
+    uint32_t properties_offset;
+    uint32_t property_count;
+    uint32_t strings_offset;
+    uint32_t strings_size;
+};
+
+struct ObjectRecord {
+    uint32_t type;            //!< index in the types table
+    uint32_t first_property;
+    uint32_t property_count;
+};
+
+struct PropertyRecord {
+    uint32_t name;            //!< string pool offset
+    PropertyType type;
+    uint8_t padding[3];
+    union {
+        int32_t int_value;
+        float float_value;
+        uint32_t string_value; //!< string pool offset
+    };
+};
+
+/// @brief Read-only access to a compiled level in memory, nothing is parsed or copied.
+class LevelView {
+public:
+    /*
+     * @brief Check header and section bounds
+     * @return false if data isn't a valid level of the supported version
+     */
+    bool open(const uint8_t* data, size_t size);
+    bool isOpen() const;
+
+    const Header& header() const;
+    const uint16_t* tiles() const;
+    size_t tileCount() const;
+
+    std::string_view typeName(uint32_t type) const;
+    uint32_t typeCount() const;
+
+    const ObjectRecord* objects() const;
+    uint32_t objectCount() const;
+    const PropertyRecord* properties(const ObjectRecord& object) const;
+
+    std::string_view string(uint32_t offset) const;
+    Property toProperty(const PropertyRecord& property) const;
+
+private:
+    template <typename T>
+    const T* section(uint32_t offset) const {
+        return reinterpret_cast<const T*>(m_data + offset);
+    }
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+/// @brief Accumulates level content and serialises it to the compiled format.
+class LevelBuilder {
+public:
+    void setMap(uint32_t width, uint32_t height, uint32_t tile_width, uint32_t tile_height);
+    void setTiles(std::vector<uint16_t> tiles);
+
+    /*
+     * @brief Start a new object, following add* calls set its properties
+     * @note Properties must be added sorted by name, objects get them in this order
+     */
+    void beginObject(const std::string& type);
+    void addInt(const std::string& name, int value);
+    void addFloat(const std::string& name, float value);
+    void addBool(const std::string& name, bool value);
+    void addString(const std::string& name, const std::string& value);
+
+    std::vector<uint8_t> build() const;
+
+private:
+    uint32_t intern(const std::string& string);
+    PropertyRecord& addProperty(const std::string& name, PropertyType type);
+
+    Header m_header = {};
+    std::vector<uint16_t> m_tiles;
+    std::vector<uint32_t> m_types;
+    std::unordered_map<std::string, uint32_t> m_type_ids;
+    std::vector<ObjectRecord> m_objects;
+    std::vector<PropertyRecord> m_properties;
+    std::string m_strings;
+    std::unordered_map<std::string, uint32_t> m_string_offsets;
+};
+
+/*
+ * @brief Convert Tiled map to the compiled format
+ * @param tmx_path [in] - map with one csv tile layer and one object group
+ * @param output [out] - compiled level
+ * @param error [out] - reason of failure
+ */
+bool compileTmx(const std::string& tmx_path, std::vector<uint8_t>& output, std::string* error = nullptr);
+
+/*
+ * @brief Parse csv tile layer (1,20,30,40,3) without copying it
+ * @param csv [in] - layer text, e.g. TinyXML2 element text
+ * @param tiles [out] - storage for `count` tiles
+ * @param count [in] - map size, the layer must have exactly this number of tiles
+ * @param error [out] - reason of failure
+ */
+bool parseTileCsv(std::string_view csv, uint16_t* tiles, size_t count, std::string* error = nullptr);
+
+/*
+ * @brief Compiled file path for the level source, the same name with .lvl extension
+ */
+std::string compiledPath(const std::string& tmx_path);
+
+/// @brief Level loaded from the compiled file next to the .tmx via mmap.
+///
+/// If there is no compiled file, or the .tmx was edited after it was compiled,
+/// the .tmx is compiled in memory instead, so levels can be edited in Tiled
+/// without rerunning the compiler.
+class LevelFile {
+public:
+    bool load(const std::string& tmx_path);
+    const LevelView& view() const;
+    bool isCompiled() const;  //!< loaded from the compiled file
+
+private:
+    MappedFile m_file;
+    std::vector<uint8_t> m_buffer;
+    LevelView m_view;
+};
+
+} // namespace level
+
+#endif // LEVEL_FORMAT_HPP
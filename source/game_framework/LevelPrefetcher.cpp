@@ -0,0 +1,154 @@
+#include <algorithm>
+
+#include "LevelPrefetcher.hpp"
+#include "Logger.hpp"
+
+LevelPrefetcher::LevelPrefetcher(size_t capacity)
+    : m_capacity(std::max<size_t>(1, capacity)) {
+    m_worker = std::thread(&LevelPrefetcher::workerLoop, this);
+}
+
+LevelPrefetcher::~LevelPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_queue_cv.notify_all();
+    m_worker.join();
+}
+
+void LevelPrefetcher::prefetch(const std::string& tmx_path) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(tmx_path);
+        if (it != m_entries.end()) {
+            touch(it->second);
+            return;
+        }
+
+        Entry& entry = m_entries[tmx_path];
+        m_lru.push_front(tmx_path);
+        entry.lru = m_lru.begin();
+        m_queue.push_back(tmx_path);
+        evict();
+    }
+    m_queue_cv.notify_one();
+}
+
+std::shared_ptr<const level::LevelFile> LevelPrefetcher::acquire(const std::string& tmx_path) {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(tmx_path);
+        // not started yet, loading here is sooner than waiting behind the queued ones
+        auto queued = std::find(m_queue.begin(), m_queue.end(), tmx_path);
+        if (queued != m_queue.end() && it != m_entries.end()) {
+            m_queue.erase(queued);
+            m_lru.erase(it->second.lru);
+            m_entries.erase(it);
+            it = m_entries.end();
+        }
+
+        if (it != m_entries.end()) {
+            touch(it->second);
+
+            if (!it->second.ready) {
+                ++m_stats.waits;
+                // the map may rehash meanwhile, look the entry up again after waking
+                m_ready_cv.wait(lock, [&] {
+                    auto entry = m_entries.find(tmx_path);
+                    return entry == m_entries.end() || entry->second.ready;
+                });
+                it = m_entries.find(tmx_path);
+            } else {
+                ++m_stats.hits;
+            }
+
+            if (it != m_entries.end() && it->second.file) {
+                return it->second.file;
+            }
+
+            // failed in background, retry below to report the error to the caller
+            if (it != m_entries.end()) {
+                m_lru.erase(it->second.lru);
+                m_entries.erase(it);
+            }
+        }
+        ++m_stats.misses;
+    }
+
+    auto file = std::make_shared<level::LevelFile>();
+    if (!file->load(tmx_path)) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(tmx_path);
+    if (it == m_entries.end()) {
+        Entry& entry = m_entries[tmx_path];
+        m_lru.push_front(tmx_path);
+        entry.lru = m_lru.begin();
+        entry.file = file;
+        entry.ready = true;
+        evict();
+    }
+
+    return file;
+}
+
+LevelPrefetcher::Stats LevelPrefetcher::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void LevelPrefetcher::touch(Entry& entry) {
+    m_lru.splice(m_lru.begin(), m_lru, entry.lru);
+}
+
+void LevelPrefetcher::evict() {
+    // levels being loaded are skipped, the worker still has to store them
+    auto it = m_lru.end();
+    while (m_entries.size() > m_capacity && it != m_lru.begin()) {
+        --it;
+        auto entry = m_entries.find(*it);
+        if (!entry->second.ready) {
+            continue;
+        }
+
+        m_entries.erase(entry);
+        it = m_lru.erase(it);
+        ++m_stats.evictions;
+    }
+}
+
+void LevelPrefetcher::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_queue_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if (m_stop) {
+            return;
+        }
+
+        const std::string path = m_queue.front();
+        m_queue.pop_front();
+
+        lock.unlock();
+        auto file = std::make_shared<level::LevelFile>();
+        const bool loaded = file->load(path);
+        lock.lock();
+
+        auto it = m_entries.find(path);
+        if (it != m_entries.end()) {
+            it->second.file = loaded ? file : nullptr;
+            it->second.ready = true;
+            ++m_stats.prefetched;
+        }
+
+        if (!loaded) {
+            LOG("PREFETCH", WARNING, "Failed to prefetch %s", path.c_str());
+        }
+
+        evict();
+        m_ready_cv.notify_all();
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef LEVEL_PREFETCHER_HPP
+#define LEVEL_PREFETCHER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "LevelFormat.hpp"
+
+/// @brief Loads levels on a worker thread ahead of the transition to them.
+///
+/// Loaded levels are kept in a small LRU cache keyed by path. A transition
+/// takes the level from the cache, waits for it if it's still loading, or
+/// loads it on the caller thread if nobody asked for it before or its
+/// loading hasn't started yet. Levels in
+/// use stay alive after eviction, the cache only drops its reference.
+class LevelPrefetcher {
+public:
+    struct Stats {
+        size_t hits = 0;       //!< level was ready
+        size_t waits = 0;      //!< level was still loading
+        size_t misses = 0;     //!< loaded on the caller thread, queued ones included
+        size_t prefetched = 0;
+        size_t evictions = 0;
+    };
+
+    explicit LevelPrefetcher(size_t capacity = 8);
+    ~LevelPrefetcher();
+
+    LevelPrefetcher(const LevelPrefetcher&) = delete;
+    LevelPrefetcher& operator=(const LevelPrefetcher&) = delete;
+
+    /*
+     * @brief Queue level loading, does nothing if it's cached or queued already
+     */
+    void prefetch(const std::string& tmx_path);
+
+    /*
+     * @brief Get loaded level, loads it on the caller thread if it wasn't prefetched
+     * @return nullptr if the level can't be loaded
+     */
+    std::shared_ptr<const level::LevelFile> acquire(const std::string& tmx_path);
+
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<level::LevelFile> file;
+        bool ready = false;
+        std::list<std::string>::iterator lru;
+    };
+
+    void touch(Entry& entry);
+    void evict();
+    void workerLoop();
+
+    size_t m_capacity;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::list<std::string> m_lru;    //!< most recently used first
+    std::deque<std::string> m_queue;
+    Stats m_stats;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queue_cv;
+    std::condition_variable m_ready_cv;
+    std::thread m_worker;
+    bool m_stop = false;
+};
+
+#endif // LEVEL_PREFETCHER_HPP
@@ -0,0 +1,48 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// @brief Read-only memory mapped file.
+///
+/// Pages are loaded by the OS on first access and shared between processes,
+/// nothing is copied into the heap.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /*
+     * @brief Map the whole file, previous mapping is released
+     * @return false if the file can't be opened or is empty
+     */
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    /*
+     * @brief Ask the OS to read the whole file ahead in one go instead of page by page on access
+     */
+    void prefetch() const;
+
+    const uint8_t* data() const;
+    size_t size() const;
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_HPP
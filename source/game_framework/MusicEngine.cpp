@@ -0,0 +1,382 @@
+#include <algorithm>
+
+#include "Logger.hpp"
+#include "MusicEngine.hpp"
+
+namespace {
+    constexpr size_t CHUNK_FRAMES = 2048;    //!< frames per decode and per chunk handed to the audio thread
+    constexpr size_t SILENCE_FRAMES = 256;   //!< played on underrun, short to catch up soon
+
+    float samplesToMs(size_t samples, const MusicTrack& track) {
+        return samples * 1000.f / (float(track.getSampleRate()) * track.getChannelCount());
+    }
+}
+
+//---------------------------------------------------------------------------
+//! MusicTrack
+//---------------------------------------------------------------------------
+bool MusicTrack::loadFromFile(const std::string& file_path) {
+    m_path = file_path;
+    m_data = nullptr;
+    m_size = 0;
+    return decodeIntro();
+}
+
+bool MusicTrack::loadFromMemory(const void* data, size_t size) {
+    m_path.clear();
+    m_data = data;
+    m_size = size;
+    return decodeIntro();
+}
+
+bool MusicTrack::openDecoder(sf::InputSoundFile& decoder) const {
+    return m_data ? decoder.openFromMemory(m_data, m_size) : decoder.openFromFile(m_path);
+}
+
+bool MusicTrack::decodeIntro() {
+    sf::InputSoundFile decoder;
+    if (!openDecoder(decoder)) {
+        return false;
+    }
+
+    m_sample_count = decoder.getSampleCount();
+    m_channel_count = decoder.getChannelCount();
+    m_sample_rate = decoder.getSampleRate();
+    m_channel_map = decoder.getChannelMap();
+
+    const uint64_t intro_samples = uint64_t(INTRO_SECONDS * m_sample_rate) * m_channel_count;
+    m_intro.resize(static_cast<size_t>(std::min(intro_samples, m_sample_count)));
+    m_intro.resize(static_cast<size_t>(decoder.read(m_intro.data(), m_intro.size())));
+    m_intro.shrink_to_fit();
+    return !m_intro.empty();
+}
+
+const std::vector<int16_t>& MusicTrack::intro() const {
+    return m_intro;
+}
+
+uint64_t MusicTrack::getSampleCount() const {
+    return m_sample_count;
+}
+
+unsigned MusicTrack::getChannelCount() const {
+    return m_channel_count;
+}
+
+unsigned MusicTrack::getSampleRate() const {
+    return m_sample_rate;
+}
+
+const std::vector<sf::SoundChannel>& MusicTrack::getChannelMap() const {
+    return m_channel_map;
+}
+
+//---------------------------------------------------------------------------
+//! MusicEngine::Voice
+//---------------------------------------------------------------------------
+MusicEngine::Voice::Voice(MusicEngine& engine)
+    : m_engine(engine) {
+}
+
+MusicEngine::Voice::~Voice() {
+    stop();
+}
+
+void MusicEngine::Voice::setFormat(const MusicTrack& track) {
+    if (track.getChannelCount() == m_channel_count && track.getSampleRate() == m_sample_rate) {
+        return;
+    }
+
+    m_channel_count = track.getChannelCount();
+    m_sample_rate = track.getSampleRate();
+    initialize(m_channel_count, m_sample_rate, track.getChannelMap());
+
+    // the voice is stopped here, nobody reads the buffers
+    chunk.assign(CHUNK_FRAMES * m_channel_count, 0);
+    ring.assign(std::max(size_t(DECODE_AHEAD_SECONDS * m_sample_rate) * m_channel_count, 4 * chunk.size()), 0);
+}
+
+bool MusicEngine::Voice::onGetData(Chunk& data) {
+    return m_engine.fill(*this, data);
+}
+
+void MusicEngine::Voice::onSeek(sf::Time) {
+    // voices are only restarted from the beginning
+    m_engine.rewind(*this);
+}
+
+//---------------------------------------------------------------------------
+//! MusicEngine
+//---------------------------------------------------------------------------
+MusicEngine::MusicEngine()
+    : m_first(*this)
+    , m_second(*this) {
+    m_thread = std::thread(&MusicEngine::decoderLoop, this);
+}
+
+MusicEngine::~MusicEngine() {
+    // voices are fed under the mutex, stop them before members go away
+    m_first.stop();
+    m_second.stop();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_decode_cv.notify_all();
+    m_thread.join();
+}
+
+void MusicEngine::play(const MusicTrack& track, int crossfade_ms) {
+    Voice* voice = m_active;
+    if (m_fading) {
+        m_fading->stop();
+    }
+
+    const bool crossfade = crossfade_ms > 0 && m_active->getStatus() == sf::SoundSource::Status::Playing;
+    if (crossfade) {
+        m_fading = m_active;
+        voice = (m_active == &m_first) ? &m_second : &m_first;
+        m_fade_ms = crossfade_ms;
+        m_fade_elapsed = 0;
+    } else {
+        m_fading = nullptr;
+    }
+
+    // SFML calls the voice under its own lock, never call into it holding ours
+    voice->stop();
+    voice->setFormat(track);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_fading) {
+            m_fading->ended = true;
+        }
+        voice->track = &track;
+        voice->intro_pos = 0;
+        voice->ring_read = 0;
+        voice->ring_size = 0;
+        voice->ended = false;
+        m_active = voice;
+        ++m_generation;
+        ++m_stats.switches;
+        m_stats.crossfades += crossfade;
+    }
+    m_decode_cv.notify_one();
+
+    voice->setPitch(m_pitch);
+    voice->setVolume(crossfade ? 0.f : 100.f);
+    voice->play();
+}
+
+void MusicEngine::resume() {
+    if (m_active->track && m_active->getStatus() != sf::SoundSource::Status::Playing) {
+        m_active->play();
+    }
+    if (m_fading && m_fading->getStatus() == sf::SoundSource::Status::Paused) {
+        m_fading->play();
+    }
+}
+
+void MusicEngine::pause() {
+    m_active->pause();
+    if (m_fading) {
+        m_fading->pause();
+    }
+}
+
+void MusicEngine::stop() {
+    m_first.stop();
+    m_second.stop();
+    m_fading = nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_first.track = nullptr;
+    m_second.track = nullptr;
+    m_decoder_track = nullptr;
+    ++m_generation;
+}
+
+void MusicEngine::setPitch(float value) {
+    m_pitch = value;
+    m_active->setPitch(value);
+}
+
+void MusicEngine::update(int delta_time) {
+    if (!m_fading || m_fading->getStatus() == sf::SoundSource::Status::Paused) {
+        return;
+    }
+
+    m_fade_elapsed += delta_time;
+    const float progress = std::min(1.f, float(m_fade_elapsed) / m_fade_ms);
+    m_active->setVolume(100.f * progress);
+    m_fading->setVolume(100.f * (1.f - progress));
+
+    if (progress >= 1.f || m_fading->getStatus() == sf::SoundSource::Status::Stopped) {
+        m_active->setVolume(100.f);
+        m_fading->stop();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fading->track = nullptr;
+        m_fading = nullptr;
+    }
+}
+
+bool MusicEngine::isFading() const {
+    return m_fading != nullptr;
+}
+
+MusicEngine::Stats MusicEngine::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.ahead_ms = m_active->track ? samplesToMs(m_active->ring_size, *m_active->track) : 0.f;
+    return stats;
+}
+
+void MusicEngine::logStats() const {
+    const Stats stats = getStats();
+    LOG("MUSIC", INFO, "%zu tracks started, %zu crossfades. Decoded %zu chunks ahead, %.0f ms buffered, min %.0f ms, %zu underruns",
+        stats.switches, stats.crossfades, stats.decoded_chunks, stats.ahead_ms, stats.min_ahead_ms, stats.underruns);
+}
+
+bool MusicEngine::fill(Voice& voice, sf::SoundStream::Chunk& data) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!voice.track) {
+        return false;
+    }
+
+    // the intro is played straight from the track
+    const std::vector<int16_t>& intro = voice.track->intro();
+    if (voice.intro_pos < intro.size()) {
+        const size_t count = std::min(voice.chunk.size(), intro.size() - voice.intro_pos);
+        data.samples = intro.data() + voice.intro_pos;
+        data.sampleCount = count;
+        voice.intro_pos += count;
+        return true;
+    }
+
+    if (voice.ring_size) {
+        const size_t count = std::min(voice.chunk.size(), voice.ring_size);
+        const size_t first = std::min(count, voice.ring.size() - voice.ring_read);
+        std::copy_n(voice.ring.begin() + voice.ring_read, first, voice.chunk.begin());
+        std::copy_n(voice.ring.begin(), count - first, voice.chunk.begin() + first);
+        voice.ring_read = (voice.ring_read + count) % voice.ring.size();
+        voice.ring_size -= count;
+
+        if (&voice == m_active) {
+            m_stats.min_ahead_ms = std::min(m_stats.min_ahead_ms, samplesToMs(voice.ring_size, *voice.track));
+        }
+
+        data.samples = voice.chunk.data();
+        data.sampleCount = count;
+        lock.unlock();
+        m_decode_cv.notify_one();
+        return true;
+    }
+
+    if (voice.ended) {
+        return false;
+    }
+
+    // keep the stream running, the decoder is behind
+    ++m_stats.underruns;
+    m_stats.min_ahead_ms = 0.f;
+    const size_t count = std::min(voice.chunk.size(), SILENCE_FRAMES * voice.track->getChannelCount());
+    std::fill_n(voice.chunk.begin(), count, int16_t(0));
+    data.samples = voice.chunk.data();
+    data.sampleCount = count;
+    return true;
+}
+
+void MusicEngine::rewind(Voice& voice) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        voice.intro_pos = 0;
+        voice.ring_read = 0;
+        voice.ring_size = 0;
+        if (&voice != m_active) {
+            return;
+        }
+
+        voice.ended = false;
+        ++m_generation;
+    }
+    m_decode_cv.notify_one();
+}
+
+bool MusicEngine::needsDecoding() const {
+    const Voice& voice = *m_active;
+    if (!voice.track || voice.ended) {
+        return false;
+    }
+
+    return m_decoder_generation != m_generation || voice.ring.size() - voice.ring_size >= voice.chunk.size();
+}
+
+void MusicEngine::decoderLoop() {
+    std::vector<int16_t> buffer;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_decode_cv.wait(lock, [this] { return m_stop || needsDecoding(); });
+        if (m_stop) {
+            return;
+        }
+
+        Voice& voice = *m_active;
+        const MusicTrack* track = voice.track;
+        const uint64_t generation = m_generation;
+        const bool reposition = m_decoder_generation != generation;
+        const bool reopen = track != m_decoder_track;
+        buffer.resize(voice.chunk.size());
+
+        // decode without the lock, the audio thread keeps playing what is buffered
+        lock.unlock();
+        bool opened = true;
+        size_t count = 0;
+        if (reposition) {
+            opened = !reopen || track->openDecoder(m_decoder);
+            if (opened) {
+                m_decoder.seek(track->intro().size());
+            }
+        } else {
+            count = static_cast<size_t>(m_decoder.read(buffer.data(), buffer.size()));
+            if (count < buffer.size()) {
+                // tracks loop, continue from the beginning
+                m_decoder.seek(uint64_t(0));
+                count += static_cast<size_t>(m_decoder.read(buffer.data() + count, buffer.size() - count));
+            }
+        }
+        lock.lock();
+
+        if (reposition && reopen) {
+            // the decoder is on this track now, even if the restart is abandoned below
+            m_decoder_track = opened ? track : nullptr;
+        }
+
+        if (generation != m_generation) {
+            continue; // restarted meanwhile
+        }
+
+        if (reposition) {
+            m_decoder_generation = generation;
+            if (!opened) {
+                LOG("MUSIC", ERROR, "Failed to open music decoder");
+                voice.ended = true;
+            }
+            continue;
+        }
+
+        if (!count) {
+            voice.ended = true;
+            continue;
+        }
+
+        const size_t write = (voice.ring_read + voice.ring_size) % voice.ring.size();
+        const size_t first = std::min(count, voice.ring.size() - write);
+        std::copy_n(buffer.begin(), first, voice.ring.begin() + write);
+        std::copy_n(buffer.begin() + first, count - first, voice.ring.begin());
+        voice.ring_size += count;
+        ++m_stats.decoded_chunks;
+    }
+}
@@ -0,0 +1,157 @@
+#ifndef MUSIC_ENGINE_HPP
+#define MUSIC_ENGINE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SFML/Audio.hpp>
+
+/// @brief Compressed music with its first seconds decoded in memory.
+///
+/// The compressed data stays in its source, a file or an asset pack entry,
+/// and is decoded while playing. The intro lets the track start right away,
+/// before the decoder has opened and sought it.
+class MusicTrack {
+public:
+    static constexpr float INTRO_SECONDS = 2.f;
+
+    bool loadFromFile(const std::string& file_path);
+
+    /*
+     * @brief Open track from memory, the data isn't copied and must outlive the track
+     */
+    bool loadFromMemory(const void* data, size_t size);
+
+    /*
+     * @brief Open own decoder on the track source, positioned at the beginning
+     */
+    bool openDecoder(sf::InputSoundFile& decoder) const;
+
+    const std::vector<int16_t>& intro() const;
+    uint64_t getSampleCount() const;
+    unsigned getChannelCount() const;
+    unsigned getSampleRate() const;
+    const std::vector<sf::SoundChannel>& getChannelMap() const;
+
+private:
+    bool decodeIntro();
+
+    std::string m_path;
+    const void* m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<int16_t> m_intro;
+    uint64_t m_sample_count = 0;
+    unsigned m_channel_count = 0;
+    unsigned m_sample_rate = 0;
+    std::vector<sf::SoundChannel> m_channel_map;
+};
+
+/// @brief Plays music through one streaming decoder.
+///
+/// There are two voices: the active one and the one fading out during a
+/// crossfade. A voice starts on the intro of its track, meanwhile the decoder
+/// thread opens the track and decodes ahead into the voice buffer from where
+/// the intro ends. Only the active voice is fed, the fading one plays out what
+/// it has buffered, so a crossfade can't be longer than the decode-ahead.
+/// Tracks loop and must stay alive while they are played.
+class MusicEngine {
+public:
+    static constexpr float DECODE_AHEAD_SECONDS = 1.f;
+
+    struct Stats {
+        size_t switches = 0;       //!< tracks started
+        size_t crossfades = 0;
+        size_t decoded_chunks = 0; //!< decoded ahead by the decoder thread
+        size_t underruns = 0;      //!< voice ran out of decoded samples, silence played
+        float ahead_ms = 0.f;      //!< decoded and not played yet, active voice
+        float min_ahead_ms = DECODE_AHEAD_SECONDS * 1000.f; //!< lowest seen after an intro
+    };
+
+    MusicEngine();
+    ~MusicEngine();
+
+    MusicEngine(const MusicEngine&) = delete;
+    MusicEngine& operator=(const MusicEngine&) = delete;
+
+    /*
+     * @brief Play track from the beginning
+     * @param track [in] - track to play
+     * @param crossfade_ms [in] - fade the current track out meanwhile, 0 - cut it
+     */
+    void play(const MusicTrack& track, int crossfade_ms = 0);
+    void resume();
+    void pause();
+    void stop();
+
+    /*
+     * @brief Pitch of the active voice, tracks started later get it too
+     */
+    void setPitch(float value);
+
+    /*
+     * @brief Advance crossfade
+     */
+    void update(int delta_time);
+
+    bool isFading() const;
+
+    Stats getStats() const;
+    void logStats() const;
+
+private:
+    class Voice : public sf::SoundStream {
+    public:
+        explicit Voice(MusicEngine& engine);
+        ~Voice() override;
+
+        void setFormat(const MusicTrack& track);
+
+        const MusicTrack* track = nullptr;
+        size_t intro_pos = 0;
+        std::vector<int16_t> ring;      //!< decoded ahead
+        size_t ring_read = 0;
+        size_t ring_size = 0;
+        std::vector<int16_t> chunk;     //!< handed to the audio thread
+        bool ended = false;             //!< nothing more will be decoded for this voice
+
+    protected:
+        bool onGetData(Chunk& data) override;
+        void onSeek(sf::Time time_offset) override;
+
+    private:
+        MusicEngine& m_engine;
+        unsigned m_channel_count = 0;
+        unsigned m_sample_rate = 0;
+    };
+
+    bool fill(Voice& voice, sf::SoundStream::Chunk& data);
+    void rewind(Voice& voice);
+    bool needsDecoding() const;
+    void decoderLoop();
+
+    Voice m_first;
+    Voice m_second;
+    Voice* m_active = &m_first;
+    Voice* m_fading = nullptr;
+    int m_fade_ms = 0;
+    int m_fade_elapsed = 0;
+    float m_pitch = 1.f;
+
+    // guarded by m_mutex, voices are fed on the audio thread
+    mutable std::mutex m_mutex;
+    std::condition_variable m_decode_cv;
+    uint64_t m_generation = 0;          //!< bumped when the active voice restarts
+    uint64_t m_decoder_generation = 0;  //!< generation the decoder is positioned for
+    const MusicTrack* m_decoder_track = nullptr;
+    Stats m_stats;
+    bool m_stop = false;
+
+    sf::InputSoundFile m_decoder;       //!< used by the decoder thread only
+    std::thread m_thread;
+};
+
+#endif // MUSIC_ENGINE_HPP
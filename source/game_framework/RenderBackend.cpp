@@ -0,0 +1,179 @@
+#include <algorithm>
+
+#include "RenderBackend.hpp"
+
+RenderStats& RenderStats::operator+=(const RenderStats& other) {
+    draw_calls += other.draw_calls;
+    texture_switches += other.texture_switches;
+    shader_switches += other.shader_switches;
+    quads += other.quads;
+    vertices += other.vertices;
+    return *this;
+}
+//---------------------------------------------------------------------------
+//! RenderBackend
+//---------------------------------------------------------------------------
+void RenderBackend::clear(const sf::Color& color) {
+    m_stats = RenderStats();
+    m_last_texture = nullptr;
+    m_last_shader = nullptr;
+    onClear(color);
+}
+
+void RenderBackend::drawVertices(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states) {
+    if (!count) {
+        return;
+    }
+
+    countStates(states);
+    m_stats.vertices += count;
+    if (type == sf::PrimitiveType::Triangles) {
+        m_stats.quads += count / 6;
+    }
+
+    onDrawVertices(vertices, count, type, states);
+}
+
+void RenderBackend::drawDrawable(const sf::Drawable& drawable, const sf::RenderStates& states) {
+    countStates(states);
+    onDrawDrawable(drawable, states);
+}
+
+const RenderStats& RenderBackend::getStats() const {
+    return m_stats;
+}
+
+void RenderBackend::countStates(const sf::RenderStates& states) {
+    ++m_stats.draw_calls;
+
+    if (states.texture != m_last_texture) {
+        ++m_stats.texture_switches;
+        m_last_texture = states.texture;
+    }
+
+    if (states.shader != m_last_shader) {
+        ++m_stats.shader_switches;
+        m_last_shader = states.shader;
+    }
+}
+//---------------------------------------------------------------------------
+//! SfmlRenderBackend
+//---------------------------------------------------------------------------
+SfmlRenderBackend::SfmlRenderBackend(sf::RenderTarget* target)
+    : m_target(target) {
+}
+
+void SfmlRenderBackend::setTarget(sf::RenderTarget* target) {
+    m_target = target;
+}
+
+sf::RenderTarget* SfmlRenderBackend::getTarget() const {
+    return m_target;
+}
+
+void SfmlRenderBackend::setView(const sf::View& view) {
+    m_target->setView(view);
+}
+
+const sf::View& SfmlRenderBackend::getView() const {
+    return m_target->getView();
+}
+
+const sf::View& SfmlRenderBackend::getDefaultView() const {
+    return m_target->getDefaultView();
+}
+
+sf::Vector2u SfmlRenderBackend::getSize() const {
+    return m_target->getSize();
+}
+
+void SfmlRenderBackend::onClear(const sf::Color& color) {
+    m_target->clear(color);
+}
+
+void SfmlRenderBackend::onDrawVertices(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states) {
+    m_target->draw(vertices, count, type, states);
+}
+
+void SfmlRenderBackend::onDrawDrawable(const sf::Drawable& drawable, const sf::RenderStates& states) {
+    m_target->draw(drawable, states);
+}
+//---------------------------------------------------------------------------
+//! RecordingRenderBackend
+//---------------------------------------------------------------------------
+RecordingRenderBackend::RecordingRenderBackend(const sf::Vector2u& size, bool recording)
+    : m_size(size)
+    , m_default_view(sf::FloatRect({ 0.f, 0.f }, sf::Vector2f(size)))
+    , m_view(m_default_view)
+    , m_recording(recording) {
+}
+
+void RecordingRenderBackend::setRecording(bool recording) {
+    m_recording = recording;
+    m_commands.clear();
+}
+
+bool RecordingRenderBackend::isRecording() const {
+    return m_recording;
+}
+
+const std::vector<RecordingRenderBackend::Command>& RecordingRenderBackend::getCommands() const {
+    return m_commands;
+}
+
+void RecordingRenderBackend::setView(const sf::View& view) {
+    m_view = view;
+}
+
+const sf::View& RecordingRenderBackend::getView() const {
+    return m_view;
+}
+
+const sf::View& RecordingRenderBackend::getDefaultView() const {
+    return m_default_view;
+}
+
+sf::Vector2u RecordingRenderBackend::getSize() const {
+    return m_size;
+}
+
+void RecordingRenderBackend::onClear(const sf::Color&) {
+    m_commands.clear();
+}
+
+void RecordingRenderBackend::onDrawVertices(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states) {
+    if (!m_recording) {
+        return;
+    }
+
+    sf::Vector2f min = vertices[0].position;
+    sf::Vector2f max = vertices[0].position;
+
+    for (size_t i = 1; i < count; ++i) {
+        min = { std::min(min.x, vertices[i].position.x), std::min(min.y, vertices[i].position.y) };
+        max = { std::max(max.x, vertices[i].position.x), std::max(max.y, vertices[i].position.y) };
+    }
+
+    Command command;
+    command.texture = states.texture;
+    command.shader = states.shader;
+    command.blend_mode = states.blendMode;
+    command.transform = states.transform;
+    command.bounds = sf::FloatRect(min, max - min);
+    command.primitive = type;
+    command.vertex_count = count;
+    m_commands.push_back(command);
+}
+
+void RecordingRenderBackend::onDrawDrawable(const sf::Drawable&, const sf::RenderStates& states) {
+    if (!m_recording) {
+        return;
+    }
+
+    Command command;
+    command.texture = states.texture;
+    command.shader = states.shader;
+    command.blend_mode = states.blendMode;
+    command.transform = states.transform;
+    m_commands.push_back(command);
+}
@@ -0,0 +1,113 @@
+#ifndef RENDER_BACKEND_HPP
+#define RENDER_BACKEND_HPP
+
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+/// @brief Counters of the work submitted to a backend since the last clear().
+struct RenderStats {
+    size_t draw_calls = 0;
+    size_t texture_switches = 0;
+    size_t shader_switches = 0;
+    size_t quads = 0;      //!< triangle list vertices / 6
+    size_t vertices = 0;
+
+    RenderStats& operator+=(const RenderStats& other);
+};
+
+/// @brief Destination of Renderer's flushed batches.
+///
+/// Each backend call is one draw call. The base class keeps per-frame
+/// statistics, a frame starts with clear().
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    void clear(const sf::Color& color);
+    void drawVertices(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states);
+    void drawDrawable(const sf::Drawable& drawable, const sf::RenderStates& states);
+    const RenderStats& getStats() const;
+
+    virtual void setView(const sf::View& view) = 0;
+    virtual const sf::View& getView() const = 0;
+    virtual const sf::View& getDefaultView() const = 0;
+    virtual sf::Vector2u getSize() const = 0;
+
+protected:
+    virtual void onClear(const sf::Color& color) = 0;
+    virtual void onDrawVertices(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states) = 0;
+    virtual void onDrawDrawable(const sf::Drawable& drawable, const sf::RenderStates& states) = 0;
+
+private:
+    void countStates(const sf::RenderStates& states);
+
+    RenderStats m_stats;
+    const sf::Texture* m_last_texture = nullptr;
+    const sf::Shader* m_last_shader = nullptr;
+};
+
+/// @brief Backend drawing to an SFML render target (window or render texture).
+class SfmlRenderBackend : public RenderBackend {
+public:
+    explicit SfmlRenderBackend(sf::RenderTarget* target = nullptr);
+
+    void setTarget(sf::RenderTarget* target);
+    sf::RenderTarget* getTarget() const;
+
+    void setView(const sf::View& view) override;
+    const sf::View& getView() const override;
+    const sf::View& getDefaultView() const override;
+    sf::Vector2u getSize() const override;
+
+protected:
+    void onClear(const sf::Color& color) override;
+    void onDrawVertices(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states) override;
+    void onDrawDrawable(const sf::Drawable& drawable, const sf::RenderStates& states) override;
+
+private:
+    sf::RenderTarget* m_target = nullptr;
+};
+
+/// @brief Backend without any graphics output.
+///
+/// Captures draw commands of the current frame, or only counts statistics
+/// when recording is off (null backend). Used for headless runs and to
+/// check render path changes by numbers.
+class RecordingRenderBackend : public RenderBackend {
+public:
+    struct Command {
+        const sf::Texture* texture = nullptr;
+        const sf::Shader* shader = nullptr;
+        sf::BlendMode blend_mode;
+        sf::Transform transform;
+        sf::FloatRect bounds;          //!< vertices bounding box, untransformed
+        sf::PrimitiveType primitive = sf::PrimitiveType::Triangles;
+        size_t vertex_count = 0;       //!< 0 for drawables, their geometry is opaque
+    };
+
+    explicit RecordingRenderBackend(const sf::Vector2u& size, bool recording = true);
+
+    void setRecording(bool recording);
+    bool isRecording() const;
+    const std::vector<Command>& getCommands() const;
+
+    void setView(const sf::View& view) override;
+    const sf::View& getView() const override;
+    const sf::View& getDefaultView() const override;
+    sf::Vector2u getSize() const override;
+
+protected:
+    void onClear(const sf::Color& color) override;
+    void onDrawVertices(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states) override;
+    void onDrawDrawable(const sf::Drawable& drawable, const sf::RenderStates& states) override;
+
+private:
+    sf::Vector2u m_size;
+    sf::View m_default_view;
+    sf::View m_view;
+    bool m_recording = true;
+    std::vector<Command> m_commands;
+};
+
+#endif // RENDER_BACKEND_HPP
@@ -0,0 +1,248 @@
+#include <cmath>
+
+#include "Renderer.hpp"
+#include "TextureAtlas.hpp"
+
+Renderer::Renderer(sf::RenderTarget* target)
+    : m_sfml_backend(target)
+    , m_backend(target ? &m_sfml_backend : nullptr) {
+}
+
+void Renderer::setTarget(sf::RenderTarget* target) {
+    flush();
+    m_sfml_backend.setTarget(target);
+    m_backend = &m_sfml_backend;
+}
+
+sf::RenderTarget* Renderer::getTarget() const {
+    return (m_backend == &m_sfml_backend) ? m_sfml_backend.getTarget()
+                                          : nullptr;
+}
+
+void Renderer::setBackend(RenderBackend* backend) {
+    flush();
+    m_backend = backend;
+}
+
+RenderBackend* Renderer::getBackend() const {
+    return m_backend;
+}
+
+void Renderer::setAtlas(const TextureAtlas* atlas) {
+    flush();
+    m_atlas = atlas;
+}
+
+const TextureAtlas* Renderer::getAtlas() const {
+    return m_atlas;
+}
+
+void Renderer::clear(const sf::Color& color) {
+    flush();
+    m_backend->clear(color);
+}
+
+const RenderStats& Renderer::getStats() const {
+    return m_backend->getStats();
+}
+
+void Renderer::setView(const sf::View& view) {
+    flush();
+    m_backend->setView(view);
+}
+
+const sf::View& Renderer::getView() const {
+    return m_backend->getView();
+}
+
+const sf::View& Renderer::getDefaultView() const {
+    return m_backend->getDefaultView();
+}
+
+sf::Vector2u Renderer::getSize() const {
+    return m_backend->getSize();
+}
+
+void Renderer::draw(const sf::Sprite& sprite, const sf::RenderStates& states) {
+    const sf::IntRect& rect = sprite.getTextureRect();
+    const sf::FloatRect local({ 0.f, 0.f }, { std::abs((float)rect.size.x), std::abs((float)rect.size.y) });
+
+    sf::RenderStates sprite_states = states;
+    sprite_states.texture = states.texture ? states.texture : &sprite.getTexture();
+    sprite_states.transform *= sprite.getTransform();
+
+    drawQuad(local, sf::FloatRect(rect), sprite.getColor(), sprite_states);
+}
+
+void Renderer::draw(const sf::Drawable& drawable, const sf::RenderStates& states) {
+    flush();
+    m_backend->drawDrawable(drawable, states);
+}
+
+void Renderer::draw(const sf::VertexArray& vertices, const sf::RenderStates& states) {
+    if (!vertices.getVertexCount()) {
+        return;
+    }
+
+    flush();
+    m_backend->drawVertices(&vertices[0], vertices.getVertexCount(), vertices.getPrimitiveType(), states);
+}
+
+void Renderer::drawQuad(const sf::FloatRect& rect, const sf::FloatRect& texture_rect,
+                        const sf::Color& color, const sf::RenderStates& states) {
+    const sf::Transform& transform = states.transform;
+
+    const sf::Vector2f lt = transform.transformPoint(rect.position);
+    const sf::Vector2f rt = transform.transformPoint(rect.position + sf::Vector2f(rect.size.x, 0.f));
+    const sf::Vector2f lb = transform.transformPoint(rect.position + sf::Vector2f(0.f, rect.size.y));
+    const sf::Vector2f rb = transform.transformPoint(rect.position + rect.size);
+
+    sf::Vector2f offset;
+    sf::RenderStates batch_states = states;
+    if (const sf::Texture* page = atlasTexture(states, offset)) {
+        batch_states.texture = page;
+    }
+
+    const float u0 = texture_rect.position.x + offset.x;
+    const float v0 = texture_rect.position.y + offset.y;
+    const float u1 = u0 + texture_rect.size.x;
+    const float v1 = v0 + texture_rect.size.y;
+
+    auto& vertices = batchFor(batch_states).vertices;
+    vertices.push_back({ lt, color, { u0, v0 } });
+    vertices.push_back({ rt, color, { u1, v0 } });
+    vertices.push_back({ lb, color, { u0, v1 } });
+    vertices.push_back({ lb, color, { u0, v1 } });
+    vertices.push_back({ rt, color, { u1, v0 } });
+    vertices.push_back({ rb, color, { u1, v1 } });
+}
+
+void Renderer::drawTriangles(const sf::Vertex* vertices, size_t count, const sf::RenderStates& states) {
+    sf::Vector2f offset;
+    sf::RenderStates batch_states = states;
+    if (const sf::Texture* page = atlasTexture(states, offset)) {
+        batch_states.texture = page;
+    }
+
+    auto& batch = batchFor(batch_states).vertices;
+    const sf::Transform& transform = states.transform;
+
+    for (size_t i = 0; i < count; ++i) {
+        batch.push_back({ transform.transformPoint(vertices[i].position), vertices[i].color, vertices[i].texCoords + offset });
+    }
+}
+
+void Renderer::drawRepeated(const sf::Texture& texture, const sf::IntRect& texture_rect, const sf::FloatRect& area,
+                            const sf::Color& color, const sf::RenderStates& states) {
+    // normalize flipped rect, the flip is kept in sign of texture coordinates
+    sf::IntRect region = texture_rect;
+    if (region.size.x < 0) {
+        region.position.x += region.size.x;
+        region.size.x = -region.size.x;
+    }
+    if (region.size.y < 0) {
+        region.position.y += region.size.y;
+        region.size.y = -region.size.y;
+    }
+
+    if (!region.size.x || !region.size.y) {
+        return;
+    }
+
+    const float sign_x = (texture_rect.size.x < 0) ? -1.f : 1.f;
+    const float sign_y = (texture_rect.size.y < 0) ? -1.f : 1.f;
+
+    sf::RenderStates quad_states = states;
+    quad_states.texture = &repeatedTexture(texture, region);
+
+    drawQuad(area, sf::FloatRect({ 0.f, 0.f }, { area.size.x * sign_x, area.size.y * sign_y }), color, quad_states);
+}
+
+void Renderer::beginZRange() {
+    if (m_z_range_depth++ == 0) {
+        m_range_begin = m_batches_count;
+    }
+}
+
+void Renderer::endZRange() {
+    if (m_z_range_depth > 0 && --m_z_range_depth == 0) {
+        m_range_begin = m_batches_count;
+    }
+}
+
+void Renderer::flush() {
+    for (size_t i = 0; i < m_batches_count; ++i) {
+        Batch& batch = m_batches[i];
+
+        if (batch.vertices.empty()) {
+            continue;
+        }
+
+        sf::RenderStates states;
+        states.texture = batch.texture;
+        states.shader = batch.shader;
+        states.blendMode = batch.blend_mode;
+        m_backend->drawVertices(batch.vertices.data(), batch.vertices.size(), sf::PrimitiveType::Triangles, states);
+        batch.vertices.clear();
+    }
+
+    m_batches_count = 0;
+    m_range_begin = 0;
+}
+
+Renderer::Batch& Renderer::batchFor(const sf::RenderStates& states) {
+    auto matches = [&states](const Batch& batch) {
+        return (batch.texture == states.texture) &&
+               (batch.shader == states.shader) &&
+               (batch.blend_mode == states.blendMode);
+    };
+
+    if (m_z_range_depth) {
+        for (size_t i = m_range_begin; i < m_batches_count; ++i) {
+            if (matches(m_batches[i])) {
+                return m_batches[i];
+            }
+        }
+    } else if (m_batches_count && matches(m_batches[m_batches_count - 1])) {
+        return m_batches[m_batches_count - 1];
+    }
+
+    if (m_batches_count == m_batches.size()) {
+        m_batches.emplace_back();
+    }
+
+    Batch& batch = m_batches[m_batches_count++];
+    batch.texture = states.texture;
+    batch.shader = states.shader;
+    batch.blend_mode = states.blendMode;
+    batch.vertices.clear();
+    return batch;
+}
+
+const sf::Texture* Renderer::atlasTexture(const sf::RenderStates& states, sf::Vector2f& offset) const {
+    const TextureAtlas::Region* region = m_atlas ? m_atlas->find(states.texture) : nullptr;
+    if (!region) {
+        return nullptr;
+    }
+
+    offset = region->offset;
+    return region->page;
+}
+
+const sf::Texture& Renderer::repeatedTexture(const sf::Texture& texture, const sf::IntRect& rect) {
+    RepeatKey key(&texture, rect.position.x, rect.position.y, rect.size.x, rect.size.y);
+
+    auto it = m_repeated_textures.find(key);
+    if (it != m_repeated_textures.end()) {
+        return *it->second;
+    }
+
+    // texture repeat works only for whole textures, so the region gets its own one
+    auto repeated = std::make_unique<sf::Texture>();
+    if (!repeated->loadFromImage(texture.copyToImage(), false, rect)) {
+        return texture;
+    }
+    repeated->setRepeated(true);
+
+    return *(m_repeated_textures[key] = std::move(repeated));
+}
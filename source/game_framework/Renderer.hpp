@@ -0,0 +1,141 @@
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "RenderBackend.hpp"
+
+class TextureAtlas;
+
+/// @brief Batching renderer on top of a render backend.
+///
+/// Sprites and textured quads are collected into vertex batches grouped by
+/// (texture, shader, blend mode) and submitted as one draw call per batch.
+/// Outside a z-range only consecutive quads with equal states are merged, so
+/// the painter's order is preserved. Inside a z-range quads may be regrouped
+/// by states, the caller guarantees they don't overlap in a way that matters.
+/// Any other drawable, or a view change, flushes pending batches first.
+/// Batches go to the backend: an SFML render target by default (setTarget),
+/// or any other one set with setBackend, e.g. headless recording.
+/// With an atlas set, batched draws from packed textures are moved to the
+/// atlas page, so sprites of different sources share batches.
+class Renderer {
+public:
+    explicit Renderer(sf::RenderTarget* target = nullptr);
+
+    /*
+     * @brief Draw to SFML render target through the built-in SFML backend
+     */
+    void setTarget(sf::RenderTarget* target);
+    sf::RenderTarget* getTarget() const;
+
+    void setBackend(RenderBackend* backend);
+    RenderBackend* getBackend() const;
+
+    /*
+     * @brief Remap draws from packed textures to atlas pages, nullptr - off
+     */
+    void setAtlas(const TextureAtlas* atlas);
+    const TextureAtlas* getAtlas() const;
+
+    /*
+     * @brief Clear the target, starts a new frame of backend statistics
+     */
+    void clear(const sf::Color& color = sf::Color::Black);
+
+    /*
+     * @brief Statistics of the current frame, complete after flush()
+     */
+    const RenderStats& getStats() const;
+
+    void setView(const sf::View& view);
+    const sf::View& getView() const;
+    const sf::View& getDefaultView() const;
+    sf::Vector2u getSize() const;
+
+    /*
+     * @brief Batched sprite draw
+     * @param states [in] - render states, a texture set here replaces the sprite's one
+     *                      (texture variant of the same layout, e.g. palette swapped)
+     */
+    void draw(const sf::Sprite& sprite, const sf::RenderStates& states = sf::RenderStates::Default);
+
+    /*
+     * @brief Unbatched draw of any other drawable, pending batches are flushed first
+     */
+    void draw(const sf::Drawable& drawable, const sf::RenderStates& states = sf::RenderStates::Default);
+
+    /*
+     * @brief Unbatched draw of a prebuilt vertex array (e.g. tile chunk), pending batches are flushed first
+     * @note Texture coordinates aren't remapped to the atlas, prebuilt arrays are baked in atlas space by their owner
+     */
+    void draw(const sf::VertexArray& vertices, const sf::RenderStates& states = sf::RenderStates::Default);
+
+    /*
+     * @brief Batched textured quad
+     * @param rect [in] - destination rectangle
+     * @param texture_rect [in] - texture rectangle, may be negative sized (flipped)
+     * @param color [in] - vertex color
+     * @param states [in] - render states, transform is applied on CPU
+     */
+    void drawQuad(const sf::FloatRect& rect, const sf::FloatRect& texture_rect,
+                  const sf::Color& color, const sf::RenderStates& states);
+
+    /*
+     * @brief Batched triangles
+     * @param vertices [in] - triangle list vertices
+     * @param count [in] - vertices count, multiple of 3
+     * @param states [in] - render states, transform is applied on CPU
+     */
+    void drawTriangles(const sf::Vertex* vertices, size_t count, const sf::RenderStates& states);
+
+    /*
+     * @brief Fill an area by repeating a texture region with a single quad
+     * @param texture [in] - source texture
+     * @param texture_rect [in] - repeated region, may be negative sized (flipped)
+     * @param area [in] - filled area, the region's left top corner is placed at area's left top
+     */
+    void drawRepeated(const sf::Texture& texture, const sf::IntRect& texture_rect, const sf::FloatRect& area,
+                      const sf::Color& color = sf::Color::White, const sf::RenderStates& states = sf::RenderStates::Default);
+
+    /*
+     * @brief Begin a range whose quads may be regrouped by render states
+     */
+    void beginZRange();
+    void endZRange();
+
+    /*
+     * @brief Submit all pending batches to the target
+     */
+    void flush();
+
+private:
+    struct Batch {
+        const sf::Texture* texture = nullptr;
+        const sf::Shader* shader = nullptr;
+        sf::BlendMode blend_mode;
+        std::vector<sf::Vertex> vertices;
+    };
+
+    Batch& batchFor(const sf::RenderStates& states);
+    const sf::Texture* atlasTexture(const sf::RenderStates& states, sf::Vector2f& offset) const;
+    const sf::Texture& repeatedTexture(const sf::Texture& texture, const sf::IntRect& rect);
+
+    SfmlRenderBackend m_sfml_backend;
+    RenderBackend* m_backend = nullptr;
+    const TextureAtlas* m_atlas = nullptr;
+    std::vector<Batch> m_batches;
+    size_t m_batches_count = 0;    //!< used batches, the rest keep their capacity
+    size_t m_range_begin = 0;      //!< first batch of the current z-range
+    int m_z_range_depth = 0;
+
+    using RepeatKey = std::tuple<const sf::Texture*, int, int, int, int>;
+    std::map<RepeatKey, std::unique_ptr<sf::Texture>> m_repeated_textures;
+};
+
+#endif // RENDERER_HPP
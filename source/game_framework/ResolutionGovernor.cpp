@@ -0,0 +1,118 @@
+#include "ResolutionGovernor.hpp"
+#include "Logger.hpp"
+
+namespace {
+    constexpr float SMOOTHING = 0.1f;        //!< weight of the newest frame in the average
+    constexpr float DOWN_THRESHOLD = 1.0f;   //!< of budget
+    constexpr float UP_THRESHOLD = 0.7f;     //!< of budget, compared with the cost at the bigger scale
+    constexpr int DOWN_FRAMES = 20;
+    constexpr int UP_FRAMES = 180;
+    constexpr int COOLDOWN_FRAMES = 60;      //!< after a switch, lets the average settle
+}
+
+ResolutionGovernor::ResolutionGovernor() {
+    setSteps({ 1.f, 0.85f, 0.7f, 0.5f });
+}
+
+void ResolutionGovernor::setSteps(const std::vector<float>& scales) {
+    m_steps.clear();
+    for (float scale : scales) {
+        StepStats step;
+        step.scale = scale;
+        m_steps.push_back(step);
+    }
+
+    if (m_steps.empty()) {
+        m_steps.emplace_back();
+    }
+
+    setStep(0);
+}
+
+void ResolutionGovernor::setBudget(float frame_ms) {
+    m_budget = frame_ms;
+}
+
+void ResolutionGovernor::setEnabled(bool enabled) {
+    m_enabled = enabled;
+    if (!enabled) {
+        setStep(0);
+    }
+}
+
+bool ResolutionGovernor::isEnabled() const {
+    return m_enabled;
+}
+
+bool ResolutionGovernor::addFrameTime(float frame_ms) {
+    StepStats& current = m_steps[m_step];
+    current.seconds += frame_ms / 1000.0;
+    ++current.frames;
+
+    m_average = m_average ? m_average + (frame_ms - m_average) * SMOOTHING
+                          : frame_ms;
+
+    if (!m_enabled) {
+        return false;
+    }
+
+    if (m_cooldown > 0) {
+        --m_cooldown;
+        return false;
+    }
+
+    m_over_frames = (m_average > m_budget * DOWN_THRESHOLD) ? m_over_frames + 1 : 0;
+
+    // fill cost grows with the area, estimate the frame at the bigger scale
+    bool fits_bigger = false;
+    if (m_step > 0) {
+        const float ratio = m_steps[m_step - 1].scale / m_steps[m_step].scale;
+        fits_bigger = (m_average * ratio * ratio < m_budget * UP_THRESHOLD);
+    }
+    m_under_frames = fits_bigger ? m_under_frames + 1 : 0;
+
+    if (m_over_frames >= DOWN_FRAMES && m_step + 1 < m_steps.size()) {
+        setStep(m_step + 1);
+        return true;
+    }
+
+    if (m_under_frames >= UP_FRAMES) {
+        setStep(m_step - 1);
+        return true;
+    }
+
+    return false;
+}
+
+void ResolutionGovernor::setStep(size_t step) {
+    if (step != m_step) {
+        LOG("GOVERNOR", INFO, "Render scale %.2f -> %.2f (avg frame %.2f ms, budget %.2f ms)",
+            m_steps[m_step].scale, m_steps[step].scale, m_average, m_budget);
+        ++m_switches;
+    }
+
+    m_step = step;
+    m_over_frames = 0;
+    m_under_frames = 0;
+    m_cooldown = COOLDOWN_FRAMES;
+}
+
+float ResolutionGovernor::getScale() const {
+    return m_steps[m_step].scale;
+}
+
+size_t ResolutionGovernor::getStep() const {
+    return m_step;
+}
+
+float ResolutionGovernor::getAverageFrameTime() const {
+    return m_average;
+}
+
+size_t ResolutionGovernor::getSwitchCount() const {
+    return m_switches;
+}
+
+const std::vector<ResolutionGovernor::StepStats>& ResolutionGovernor::getStats() const {
+    return m_steps;
+}
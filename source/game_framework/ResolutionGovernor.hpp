@@ -0,0 +1,66 @@
+#ifndef RESOLUTION_GOVERNOR_HPP
+#define RESOLUTION_GOVERNOR_HPP
+
+#include <cstddef>
+#include <vector>
+
+/// @brief Chooses render scale from measured frame times.
+///
+/// Frame times are smoothed and compared with the budget. The scale steps
+/// down after a short run of frames over budget and steps up only after a
+/// long run of frames well under budget, the gap between both thresholds and
+/// dwell times is the hysteresis which keeps the scale from oscillating.
+class ResolutionGovernor {
+public:
+    struct StepStats {
+        float scale = 1.f;
+        double seconds = 0.0;  //!< time spent at this step
+        size_t frames = 0;
+    };
+
+    ResolutionGovernor();
+
+    /*
+     * @brief Set available scales
+     * @param scales [in] - descending scales, the first one is the preferred (usually 1)
+     */
+    void setSteps(const std::vector<float>& scales);
+
+    /*
+     * @brief Set frame time budget in milliseconds
+     */
+    void setBudget(float frame_ms);
+
+    /*
+     * @brief Disabled governor keeps the first step
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    /*
+     * @brief Feed time of the last frame, may change the scale for the next one
+     * @return true if the scale was changed
+     */
+    bool addFrameTime(float frame_ms);
+
+    float getScale() const;
+    size_t getStep() const;
+    float getAverageFrameTime() const;
+    size_t getSwitchCount() const;
+    const std::vector<StepStats>& getStats() const;
+
+private:
+    void setStep(size_t step);
+
+    std::vector<StepStats> m_steps;
+    size_t m_step = 0;
+    float m_budget = 1000.f / 60.f;
+    float m_average = 0.f;
+    int m_over_frames = 0;
+    int m_under_frames = 0;
+    int m_cooldown = 0;
+    size_t m_switches = 0;
+    bool m_enabled = true;
+};
+
+#endif // RESOLUTION_GOVERNOR_HPP
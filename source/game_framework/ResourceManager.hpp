@@ -1,20 +1,76 @@
 #ifndef RESOURCE_MANAGER_HPP
 #define RESOURCE_MANAGER_HPP
 
+#include <functional>
+#include <list>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
+#include "AssetPack.hpp"
 #include "Logger.hpp"
 
+template <typename T>
+class ResourceManager;
+
+/*
+ * @class ResourceHandle
+ * @brief Counted reference to a managed resource, the resource isn't evicted while any handle holds it
+ * @tparam T - resource type
+ */
+template <typename T>
+class ResourceHandle {
+public:
+    ResourceHandle() = default;
+    ResourceHandle(const ResourceHandle& other);
+    ResourceHandle(ResourceHandle&& other) noexcept;
+    ResourceHandle& operator=(ResourceHandle other) noexcept;
+    ~ResourceHandle();
+
+    T* get() const;
+    T& operator*() const { return *get(); }
+    T* operator->() const { return get(); }
+    explicit operator bool() const { return get() != nullptr; }
+
+private:
+    friend class ResourceManager<T>;
+    using Entry = typename ResourceManager<T>::Entry;
+
+    ResourceHandle(ResourceManager<T>* manager, Entry* entry);
+
+    ResourceManager<T>* m_manager = nullptr;
+    Entry* m_entry = nullptr;
+};
 
 /*
  * @class ResourceManager
  * @brief Resource manager class
  * @tparam T - resource type
+ *
+ * Resources are either loaded right away (loadFromFile, loadFromPack, add)
+ * or declared with a loader and loaded on the first get() / acquire().
+ * When resident resources exceed the memory budget, the least recently used
+ * ones nobody references are freed; they are loaded again on the next request.
+ * Pointers returned by get() can't be tracked, so such resources are never evicted,
+ * use acquire() for resources which may be evicted.
  */
 template <typename T>
 class ResourceManager {
 public:
+    using Handle = ResourceHandle<T>;
+    using Loader = std::function<std::unique_ptr<T>()>;
+    using EvictionListener = std::function<void(const T& resource)>;
+
+    struct Stats {
+        size_t resident_bytes = 0;
+        size_t resident = 0;       //!< loaded resources
+        size_t total = 0;          //!< loaded and declared ones
+        size_t loads = 0;          //!< lazy loads, reloads after eviction included
+        size_t evictions = 0;
+        size_t budget = 0;         //!< 0 - unlimited
+    };
+
     ResourceManager() = default;
     ~ResourceManager() = default;
 
@@ -23,7 +79,7 @@ public:
     ResourceManager operator=(const ResourceManager&) = delete;
     ResourceManager(ResourceManager&&) = delete;
     ResourceManager operator=(ResourceManager&&) = delete;
-    
+
     /*
      * @brief Load resource from file
      * @param name [in] - resource name
@@ -33,27 +89,107 @@ public:
      * @return true if resource was loaded successfully, false otherwise
      */
     bool loadFromFile(const std::string& name, const std::string& file_path) {
-        auto it = m_resources.find(name);
-        if (it != m_resources.end()) {
+        if (contains(name)) {
             LOG("RES_MNG", ERROR, "Resource with name %s already exists", name.c_str());
             return false;
         }
- 
-        auto resource = new T();
-        if (!resource->loadFromFile(file_path)) {
+
+        auto loader = [file_path]() {
+            auto resource = std::make_unique<T>();
+            return resource->loadFromFile(file_path) ? std::move(resource) : nullptr;
+        };
+
+        auto resource = loader();
+        if (!resource) {
             LOG("RES_MNG", ERROR, "Failed to load %s", name.c_str());
             return false;
         }
 
         LOG("RES_MNG", DEBUG, "Loaded resource '%s' from file %s", name.c_str(), file_path.c_str());
-        m_resources[name] = resource;
-        return true;
+        return insert(name, std::move(resource), loader);
+    }
+
+    /*
+     * @brief Load resource from asset pack entry, without opening any file
+     * @param name [in] - resource name
+     * @param pack [in] - opened pack, must outlive resources streamed from it
+     * @param entry [in] - entry name, path relative to the resource root
+     * @note Resource type must have loadFromMemory method, specialize for other types
+     * @return true if resource was loaded successfully, false otherwise
+     */
+    bool loadFromPack(const std::string& name, const AssetPack& pack, const std::string& entry) {
+        if (contains(name)) {
+            LOG("RES_MNG", ERROR, "Resource with name %s already exists", name.c_str());
+            return false;
+        }
+
+        const std::span<const uint8_t> data = pack.find(entry);
+        if (data.empty()) {
+            LOG("RES_MNG", ERROR, "No %s in asset pack", entry.c_str());
+            return false;
+        }
+
+        auto loader = [data]() {
+            auto resource = std::make_unique<T>();
+            return resource->loadFromMemory(data.data(), data.size()) ? std::move(resource) : nullptr;
+        };
+
+        auto resource = loader();
+        if (!resource) {
+            LOG("RES_MNG", ERROR, "Failed to load %s", name.c_str());
+            return false;
+        }
+
+        LOG("RES_MNG", DEBUG, "Loaded resource '%s' from pack entry %s", name.c_str(), entry.c_str());
+        return insert(name, std::move(resource), loader);
     }
 
     /*
-     * @brief Get resource by name
+     * @brief Register resource which is loaded on the first request
+     * @param name [in] - resource name
+     * @param loader [in] - creates the resource, returns nullptr on failure, may be called again after eviction
+     * @return false if name is already used
+     */
+    bool declare(const std::string& name, Loader loader) {
+        if (contains(name)) {
+            LOG("RES_MNG", ERROR, "Resource with name %s already exists", name.c_str());
+            return false;
+        }
+
+        return insert(name, nullptr, std::move(loader));
+    }
+
+    /*
+     * @brief Add already created resource, manager takes ownership
+     * @param name [in] - resource name
+     * @param resource [in] - resource
+     * @return true if resource was added, false if name is already used
+     * @note The resource can't be reloaded, so it's never evicted
+     */
+    bool add(const std::string& name, T* resource) {
+        if (contains(name)) {
+            LOG("RES_MNG", ERROR, "Resource with name %s already exists", name.c_str());
+            delete resource;
+            return false;
+        }
+
+        return insert(name, std::unique_ptr<T>(resource), nullptr);
+    }
+
+    /*
+     * @brief Check if resource exists
+     * @param name [in] - resource name
+     * @return true if resource with given name exists, loaded or declared
+     */
+    bool contains(const std::string& name) const {
+        return m_resources.find(name) != m_resources.end();
+    }
+
+    /*
+     * @brief Get resource by name, loads declared resource
      * @param name [in] - resource name
      * @return pointer to resource if it was found, nullptr otherwise
+     * @note The resource stays resident from now on, see acquire()
      */
     T* get(const std::string& name) {
         auto it = m_resources.find(name);
@@ -62,13 +198,16 @@ public:
             return nullptr;
         }
 
-        return it->second;
+        it->second.pinned = true;
+        T* resource = load(it->second);
+        evict();
+        return resource;
     }
 
     /*
      * @brief Get resource by name (const version)
      * @param name [in] - resource name
-     * @return pointer to resource if it was found, nullptr otherwise
+     * @return pointer to resource if it's resident, nullptr otherwise
      */
     const T* get(const std::string& name) const {
         auto it = m_resources.find(name);
@@ -76,11 +215,206 @@ public:
             LOG("RES_MNG", WARNING, "Resource with name %s not found", name.c_str());
             return nullptr;
         }
-        return it->second;
+        return it->second.resource.get();
+    }
+
+    /*
+     * @brief Get counted reference, loads declared resource
+     * @param name [in] - resource name
+     * @return empty handle if there is no such resource or it failed to load
+     */
+    Handle acquire(const std::string& name) {
+        auto it = m_resources.find(name);
+        if (it == m_resources.end()) {
+            LOG("RES_MNG", ERROR, "Loaded resource '%s' not found!", name.c_str());
+            return Handle();
+        }
+
+        if (!load(it->second)) {
+            return Handle();
+        }
+
+        Handle handle(this, &it->second);
+        evict();
+        return handle;
+    }
+
+    /*
+     * @brief Limit memory of resident resources, unreferenced ones are evicted to fit
+     * @param bytes [in] - budget, 0 - unlimited
+     */
+    void setMemoryBudget(size_t bytes) {
+        m_budget = bytes;
+        evict();
+    }
+
+    /*
+     * @brief Called right before an evicted resource is freed, to drop anything keyed by its address
+     * @param listener [in] - listener, empty - none
+     */
+    void setEvictionListener(EvictionListener listener) {
+        m_eviction_listener = std::move(listener);
+    }
+
+    /*
+     * @brief Evict every resource which can be evicted, regardless of the budget
+     */
+    void trim() {
+        evict(0);
+    }
+
+    Stats getStats() const {
+        Stats stats = m_stats;
+        stats.resident_bytes = m_resident_bytes;
+        stats.resident = m_lru.size();
+        stats.total = m_resources.size();
+        stats.budget = m_budget;
+        return stats;
+    }
+
+    /*
+     * @brief Memory held by the resource, specialize for resource types with own storage
+     */
+    static size_t residentSize(const T& resource) {
+        return sizeof(resource);
     }
 
 protected:
-    std::unordered_map<std::string, T*> m_resources;
+    friend class ResourceHandle<T>;
+
+    struct Entry {
+        std::string name;
+        std::unique_ptr<T> resource;
+        Loader loader;                 //!< empty - can't be reloaded, never evicted
+        size_t bytes = 0;
+        size_t refs = 0;               //!< handles
+        bool pinned = false;           //!< handed out by get()
+        typename std::list<Entry*>::iterator lru;
+    };
+
+    bool insert(const std::string& name, std::unique_ptr<T> resource, Loader loader) {
+        Entry& entry = m_resources[name];
+        entry.name = name;
+        entry.loader = std::move(loader);
+        if (resource) {
+            store(entry, std::move(resource));
+            evict();
+        }
+        return true;
+    }
+
+    // callers hold the entry (handle or pin) before evicting, so it can't be evicted right away
+    T* load(Entry& entry) {
+        if (entry.resource) {
+            m_lru.splice(m_lru.begin(), m_lru, entry.lru);
+            return entry.resource.get();
+        }
+
+        auto resource = entry.loader ? entry.loader() : nullptr;
+        if (!resource) {
+            LOG("RES_MNG", ERROR, "Failed to load %s", entry.name.c_str());
+            return nullptr;
+        }
+
+        ++m_stats.loads;
+        LOG("RES_MNG", DEBUG, "Loaded resource '%s' on request", entry.name.c_str());
+        return store(entry, std::move(resource));
+    }
+
+    T* store(Entry& entry, std::unique_ptr<T> resource) {
+        entry.resource = std::move(resource);
+        entry.bytes = residentSize(*entry.resource);
+        m_resident_bytes += entry.bytes;
+        m_lru.push_front(&entry);
+        entry.lru = m_lru.begin();
+        return entry.resource.get();
+    }
+
+    void release(Entry& entry) {
+        --entry.refs;
+        if (!entry.refs) {
+            evict();
+        }
+    }
+
+    void evict() {
+        if (m_budget) {
+            evict(m_budget);
+        }
+    }
+
+    void evict(size_t budget) {
+        auto it = m_lru.end();
+        while (m_resident_bytes > budget && it != m_lru.begin()) {
+            Entry* entry = *--it;
+            if (entry->refs || entry->pinned || !entry->loader) {
+                continue;
+            }
+
+            LOG("RES_MNG", DEBUG, "Evicted resource '%s', %zu bytes", entry->name.c_str(), entry->bytes);
+            if (m_eviction_listener) {
+                // a reloaded resource may get the same address
+                m_eviction_listener(*entry->resource);
+            }
+            m_resident_bytes -= entry->bytes;
+            entry->resource.reset();
+            entry->bytes = 0;
+            it = m_lru.erase(it);
+            ++m_stats.evictions;
+        }
+    }
+
+    std::unordered_map<std::string, Entry> m_resources;
+    std::list<Entry*> m_lru;           //!< resident entries, most recently used first
+    size_t m_resident_bytes = 0;
+    size_t m_budget = 0;
+    Stats m_stats;
+    EvictionListener m_eviction_listener;
 };
 
+//---------------------------------------------------------------------------
+// Inline Functions
+//---------------------------------------------------------------------------
+
+template <typename T>
+ResourceHandle<T>::ResourceHandle(ResourceManager<T>* manager, Entry* entry)
+    : m_manager(manager)
+    , m_entry(entry) {
+    ++m_entry->refs;
+}
+
+template <typename T>
+ResourceHandle<T>::ResourceHandle(const ResourceHandle& other)
+    : m_manager(other.m_manager)
+    , m_entry(other.m_entry) {
+    if (m_entry) {
+        ++m_entry->refs;
+    }
+}
+
+template <typename T>
+ResourceHandle<T>::ResourceHandle(ResourceHandle&& other) noexcept
+    : m_manager(std::exchange(other.m_manager, nullptr))
+    , m_entry(std::exchange(other.m_entry, nullptr)) {
+}
+
+template <typename T>
+ResourceHandle<T>& ResourceHandle<T>::operator=(ResourceHandle other) noexcept {
+    std::swap(m_manager, other.m_manager);
+    std::swap(m_entry, other.m_entry);
+    return *this;
+}
+
+template <typename T>
+ResourceHandle<T>::~ResourceHandle() {
+    if (m_entry) {
+        m_manager->release(*m_entry);
+    }
+}
+
+template <typename T>
+T* ResourceHandle<T>::get() const {
+    return m_entry ? m_entry->resource.get() : nullptr;
+}
+
 #endif // !RESOURCE_MANAGER_HPP
@@ -0,0 +1,539 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFT_RENDER_SSE2
+#endif
+
+#include "SoftwareRenderBackend.hpp"
+#include "Logger.hpp"
+
+// Pixels are kept as uint32_t in the RGBA byte order of sf::Image, so on
+// little-endian targets the alpha is the most significant byte.
+namespace {
+    constexpr uint32_t WHITE = 0xffffffff;
+
+    uint32_t packColor(const sf::Color& color) {
+        return uint32_t(color.r) | (uint32_t(color.g) << 8) | (uint32_t(color.b) << 16) | (uint32_t(color.a) << 24);
+    }
+
+    // x / 255 rounded, exact for x in [0, 255 * 255]
+    inline uint32_t div255(uint32_t x) {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    inline uint32_t modulate(uint32_t texel, uint32_t color) {
+        if (color == WHITE) {
+            return texel;
+        }
+
+        uint32_t result = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            result |= div255(((texel >> shift) & 0xff) * ((color >> shift) & 0xff)) << shift;
+        }
+        return result;
+    }
+
+    // dst = src * a + dst * (1 - a), alpha channel: a + dst_a * (1 - a)
+    inline uint32_t blendAlpha(uint32_t src, uint32_t dst) {
+        const uint32_t a = src >> 24;
+        if (a == 255) {
+            return src;
+        }
+        if (a == 0) {
+            return dst;
+        }
+
+        const uint32_t inv = 255 - a;
+        uint32_t result = 0;
+        for (int shift = 0; shift < 24; shift += 8) {
+            result |= div255(((src >> shift) & 0xff) * a + ((dst >> shift) & 0xff) * inv) << shift;
+        }
+        return result | (div255(a * 255 + (dst >> 24) * inv) << 24);
+    }
+
+    // dst = src + dst * (1 - a)
+    inline uint32_t blendPremultiplied(uint32_t src, uint32_t dst) {
+        const uint32_t inv = 255 - (src >> 24);
+        uint32_t result = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            result |= div255(((src >> shift) & 0xff) * 255 + ((dst >> shift) & 0xff) * inv) << shift;
+        }
+        return result;
+    }
+
+#ifdef SOFT_RENDER_SSE2
+    inline __m128i div255(__m128i x) {
+        x = _mm_add_epi16(x, _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+
+    // 2 pixels as 8 x u16 lanes: blend with per-pixel factors
+    inline __m128i blendHalf(__m128i src, __m128i dst, bool premultiplied) {
+        const __m128i full = _mm_set1_epi16(255);
+        __m128i alpha = _mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3));
+        alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i inv = _mm_sub_epi16(full, alpha);
+
+        __m128i factor = full;
+        if (!premultiplied) { // colors are multiplied by alpha, alpha itself by one
+            const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+            factor = _mm_or_si128(_mm_andnot_si128(alpha_lanes, alpha), _mm_and_si128(alpha_lanes, full));
+        }
+
+        return div255(_mm_add_epi16(_mm_mullo_epi16(src, factor), _mm_mullo_epi16(dst, inv)));
+    }
+
+    inline __m128i blend4(__m128i src, __m128i dst, bool premultiplied) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lo = blendHalf(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero), premultiplied);
+        const __m128i hi = blendHalf(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero), premultiplied);
+        return _mm_packus_epi16(lo, hi);
+    }
+
+    inline __m128i modulate4(__m128i texels, __m128i color16) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lo = div255(_mm_mullo_epi16(_mm_unpacklo_epi8(texels, zero), color16));
+        const __m128i hi = div255(_mm_mullo_epi16(_mm_unpackhi_epi8(texels, zero), color16));
+        return _mm_packus_epi16(lo, hi);
+    }
+#endif
+
+    inline int wrap(int value, int size) {
+        value %= size;
+        return (value < 0) ? value + size : value;
+    }
+
+    inline int texelIndex(int value, int size, bool repeated) {
+        return repeated ? wrap(value, size) : std::clamp(value, 0, size - 1);
+    }
+}
+
+SoftwareRenderBackend::SoftwareRenderBackend(const sf::Vector2u& size, unsigned threads)
+    : m_size(size)
+    , m_pixels(size_t(size.x) * size.y, m_clear_color)
+    , m_default_view(sf::FloatRect({ 0.f, 0.f }, sf::Vector2f(size)))
+    , m_view(m_default_view) {
+    setThreadCount(threads);
+}
+
+SoftwareRenderBackend::~SoftwareRenderBackend() {
+    stopWorkers();
+}
+
+void SoftwareRenderBackend::setThreadCount(unsigned threads) {
+    stopWorkers();
+    m_threads = std::clamp(threads, 1u, std::max(1u, m_size.y));
+    startWorkers();
+}
+
+void SoftwareRenderBackend::setTextureImage(const sf::Texture& texture, const sf::Image& image) {
+    auto soft = std::make_unique<SoftTexture>();
+    soft->size = sf::Vector2i(image.getSize());
+    soft->repeated = texture.isRepeated();
+    soft->pixels.resize(size_t(soft->size.x) * soft->size.y);
+    std::memcpy(soft->pixels.data(), image.getPixelsPtr(), soft->pixels.size() * sizeof(uint32_t));
+    m_textures[&texture] = std::move(soft);
+}
+
+void SoftwareRenderBackend::invalidateTexture(const sf::Texture& texture) {
+    m_textures.erase(&texture);
+}
+
+const SoftwareRenderBackend::SoftTexture* SoftwareRenderBackend::softTexture(const sf::Texture* texture) {
+    if (!texture) {
+        return nullptr;
+    }
+
+    auto it = m_textures.find(texture);
+    if (it == m_textures.end()) {
+        setTextureImage(*texture, texture->copyToImage());
+        it = m_textures.find(texture);
+    }
+
+    return it->second->pixels.empty() ? nullptr : it->second.get();
+}
+
+const uint32_t* SoftwareRenderBackend::getPixels() const {
+    return m_pixels.data();
+}
+
+void SoftwareRenderBackend::copyToImage(sf::Image& image) const {
+    image.resize(m_size, reinterpret_cast<const std::uint8_t*>(m_pixels.data()));
+}
+
+void SoftwareRenderBackend::setDefaultView(const sf::View& view) {
+    m_default_view = view;
+    m_view = view;
+}
+
+void SoftwareRenderBackend::setView(const sf::View& view) {
+    m_view = view;
+}
+
+const sf::View& SoftwareRenderBackend::getView() const {
+    return m_view;
+}
+
+const sf::View& SoftwareRenderBackend::getDefaultView() const {
+    return m_default_view;
+}
+
+sf::Vector2u SoftwareRenderBackend::getSize() const {
+    return m_size;
+}
+
+void SoftwareRenderBackend::onClear(const sf::Color& color) {
+    m_clear_color = packColor(color);
+    m_vertices.clear();
+    m_commands.clear();
+}
+
+sf::Transform SoftwareRenderBackend::pixelTransform(const sf::Transform& transform) const {
+    // world -> normalized device coordinates -> viewport pixels
+    const sf::FloatRect& viewport = m_view.getViewport();
+    const float width = viewport.size.x * m_size.x;
+    const float height = viewport.size.y * m_size.y;
+
+    sf::Transform to_pixels(width / 2.f, 0.f, viewport.position.x * m_size.x + width / 2.f,
+                            0.f, -height / 2.f, viewport.position.y * m_size.y + height / 2.f,
+                            0.f, 0.f, 1.f);
+
+    return to_pixels * m_view.getTransform() * transform;
+}
+
+void SoftwareRenderBackend::record(const sf::Vertex* vertices, size_t count, const sf::RenderStates& states) {
+    Command command;
+    command.first_vertex = m_vertices.size();
+    command.count = count - count % 3;
+    command.texture = softTexture(states.texture);
+
+    if (states.blendMode == sf::BlendNone) {
+        command.blend = Blend::NONE;
+    } else if (states.blendMode == sf::BlendMode(sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha)) {
+        command.blend = Blend::PREMULTIPLIED;
+    }
+
+    const sf::Transform transform = pixelTransform(states.transform);
+    for (size_t i = 0; i < command.count; ++i) {
+        m_vertices.push_back({ transform.transformPoint(vertices[i].position), vertices[i].color, vertices[i].texCoords });
+    }
+
+    if (command.count) {
+        m_commands.push_back(command);
+    }
+}
+
+void SoftwareRenderBackend::onDrawVertices(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states) {
+    if (type != sf::PrimitiveType::Triangles) {
+        if (!m_unsupported_logged) {
+            LOG("SOFT_RENDER", WARNING, "Only triangle lists are rasterised");
+            m_unsupported_logged = true;
+        }
+        return;
+    }
+
+    record(vertices, count, states);
+}
+
+void SoftwareRenderBackend::onDrawDrawable(const sf::Drawable& drawable, const sf::RenderStates& states) {
+    // rectangles are the only shapes the game draws directly (outlined labels)
+    auto shape = dynamic_cast<const sf::RectangleShape*>(&drawable);
+    if (!shape) {
+        if (!m_unsupported_logged) {
+            LOG("SOFT_RENDER", WARNING, "Drawable type is not supported, skipped");
+            m_unsupported_logged = true;
+        }
+        return;
+    }
+
+    const sf::Vector2f size = shape->getSize();
+    const float t = shape->getOutlineThickness();
+    std::vector<sf::Vertex> vertices;
+
+    auto addRect = [&vertices](float x, float y, float w, float h, const sf::Color& color) {
+        if (!color.a || w <= 0.f || h <= 0.f) {
+            return;
+        }
+        const sf::Vertex lt{ { x, y }, color }, rt{ { x + w, y }, color };
+        const sf::Vertex lb{ { x, y + h }, color }, rb{ { x + w, y + h }, color };
+        vertices.insert(vertices.end(), { lt, rt, lb, lb, rt, rb });
+    };
+
+    addRect(0.f, 0.f, size.x, size.y, shape->getFillColor());
+    if (t > 0.f) {
+        const sf::Color outline = shape->getOutlineColor();
+        addRect(-t, -t, size.x + 2 * t, t, outline);
+        addRect(-t, size.y, size.x + 2 * t, t, outline);
+        addRect(-t, 0.f, t, size.y, outline);
+        addRect(size.x, 0.f, t, size.y, outline);
+    }
+
+    sf::RenderStates shape_states = states;
+    shape_states.texture = nullptr;
+    shape_states.transform *= shape->getTransform();
+    record(vertices.data(), vertices.size(), shape_states);
+}
+
+void SoftwareRenderBackend::finish() {
+    if (m_threads == 1) {
+        rasterise({ 0, static_cast<int>(m_size.y) });
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_busy_workers = m_threads;
+    ++m_frame_generation;
+    m_start_cv.notify_all();
+    m_done_cv.wait(lock, [this] { return m_busy_workers == 0; });
+}
+
+void SoftwareRenderBackend::startWorkers() {
+    if (m_threads == 1) {
+        return;
+    }
+
+    m_stop = false;
+    for (unsigned i = 0; i < m_threads; ++i) {
+        m_workers.emplace_back(&SoftwareRenderBackend::workerLoop, this, i, m_frame_generation);
+    }
+}
+
+void SoftwareRenderBackend::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start_cv.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void SoftwareRenderBackend::workerLoop(unsigned index, uint64_t generation) {
+    const int band_height = (m_size.y + m_threads - 1) / m_threads;
+    const Band band{ static_cast<int>(index) * band_height,
+                     std::min(static_cast<int>(m_size.y), static_cast<int>(index + 1) * band_height) };
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start_cv.wait(lock, [&] { return m_stop || m_frame_generation != generation; });
+            if (m_stop) {
+                return;
+            }
+            generation = m_frame_generation;
+        }
+
+        rasterise(band);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busy_workers == 0) {
+            m_done_cv.notify_one();
+        }
+    }
+}
+
+void SoftwareRenderBackend::rasterise(const Band& band) {
+    if (band.top >= band.bottom) {
+        return;
+    }
+
+    std::fill(m_pixels.begin() + size_t(band.top) * m_size.x, m_pixels.begin() + size_t(band.bottom) * m_size.x, m_clear_color);
+
+    for (const auto& command : m_commands) {
+        const sf::Vertex* vertices = &m_vertices[command.first_vertex];
+        size_t i = 0;
+
+        // quads as emitted by Renderer and TileRenderer: lt, rt, lb, lb, rt, rb
+        for (; i + 6 <= command.count; i += 6) {
+            const sf::Vertex* v = vertices + i;
+            const bool axis_aligned =
+                v[0].position.y == v[1].position.y && v[0].position.x == v[2].position.x &&
+                v[5].position.x == v[1].position.x && v[5].position.y == v[2].position.y &&
+                v[0].texCoords.y == v[1].texCoords.y && v[0].texCoords.x == v[2].texCoords.x &&
+                v[2].position == v[3].position && v[1].position == v[4].position &&
+                v[0].color == v[5].color;
+
+            if (axis_aligned) {
+                drawQuad(command, v, band);
+            } else {
+                drawTriangle(command, v, band);
+                drawTriangle(command, v + 3, band);
+            }
+        }
+
+        for (; i + 3 <= command.count; i += 3) {
+            drawTriangle(command, vertices + i, band);
+        }
+    }
+}
+
+void SoftwareRenderBackend::drawQuad(const Command& command, const sf::Vertex* quad, const Band& band) {
+    float x0 = quad[0].position.x, x1 = quad[5].position.x;
+    float y0 = quad[0].position.y, y1 = quad[5].position.y;
+    float u0 = quad[0].texCoords.x, u1 = quad[5].texCoords.x;
+    float v0 = quad[0].texCoords.y, v1 = quad[5].texCoords.y;
+
+    // flips by transform are moved to texture coordinates
+    if (x1 < x0) {
+        std::swap(x0, x1);
+        std::swap(u0, u1);
+    }
+    if (y1 < y0) {
+        std::swap(y0, y1);
+        std::swap(v0, v1);
+    }
+
+    // pixel centers inside the rect
+    const int left = std::max(0, static_cast<int>(std::ceil(x0 - 0.5f)));
+    const int right = std::min(static_cast<int>(m_size.x), static_cast<int>(std::ceil(x1 - 0.5f)));
+    const int top = std::max(band.top, static_cast<int>(std::ceil(y0 - 0.5f)));
+    const int bottom = std::min(band.bottom, static_cast<int>(std::ceil(y1 - 0.5f)));
+
+    if (left >= right || top >= bottom) {
+        return;
+    }
+
+    const uint32_t color = packColor(quad[0].color);
+    const SoftTexture* texture = command.texture;
+    const bool premultiplied = (command.blend == Blend::PREMULTIPLIED);
+
+    auto store = [&command, premultiplied](uint32_t src, uint32_t& dst) {
+        if (command.blend == Blend::NONE) {
+            dst = src;
+        } else {
+            dst = premultiplied ? blendPremultiplied(src, dst) : blendAlpha(src, dst);
+        }
+    };
+
+    if (!texture) { // solid fill
+        for (int y = top; y < bottom; ++y) {
+            uint32_t* row = &m_pixels[size_t(y) * m_size.x];
+            for (int x = left; x < right; ++x) {
+                store(color, row[x]);
+            }
+        }
+        return;
+    }
+
+    // texel coordinates in 16.16 fixed point, stepped per pixel
+    const float du = (u1 - u0) / (x1 - x0);
+    const float dv = (v1 - v0) / (y1 - y0);
+    const int32_t u_step = static_cast<int32_t>(du * 65536.f);
+    const int32_t u_start = static_cast<int32_t>((u0 + (left + 0.5f - x0) * du) * 65536.f);
+    const sf::Vector2i size = texture->size;
+
+#ifdef SOFT_RENDER_SSE2
+    const __m128i color16 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(color)), _mm_setzero_si128());
+    const __m128i color16x2 = _mm_unpacklo_epi64(color16, color16);
+#endif
+
+    for (int y = top; y < bottom; ++y) {
+        const int ty = texelIndex(static_cast<int>(std::floor(v0 + (y + 0.5f - y0) * dv)), size.y, texture->repeated);
+        const uint32_t* texels = &texture->pixels[size_t(ty) * size.x];
+        uint32_t* row = &m_pixels[size_t(y) * m_size.x];
+        int32_t u = u_start;
+        int x = left;
+
+#ifdef SOFT_RENDER_SSE2
+        if (command.blend != Blend::NONE) {
+            for (; x + 4 <= right; x += 4) {
+                alignas(16) uint32_t src[4];
+                for (int k = 0; k < 4; ++k, u += u_step) {
+                    src[k] = texels[texelIndex(u >> 16, size.x, texture->repeated)];
+                }
+
+                __m128i pixels = _mm_load_si128(reinterpret_cast<const __m128i*>(src));
+                if (color != WHITE) {
+                    pixels = modulate4(pixels, color16x2);
+                }
+
+                __m128i* dst = reinterpret_cast<__m128i*>(row + x);
+
+                // fully transparent and fully opaque runs are the common case in sprite sheets
+                if (!premultiplied) {
+                    const int transparent = _mm_movemask_epi8(_mm_cmpeq_epi8(pixels, _mm_setzero_si128())) & 0x8888;
+                    const int opaque = _mm_movemask_epi8(_mm_cmpeq_epi8(pixels, _mm_set1_epi32(-1))) & 0x8888;
+
+                    if (transparent == 0x8888) {
+                        continue;
+                    }
+                    if (opaque == 0x8888) {
+                        _mm_storeu_si128(dst, pixels);
+                        continue;
+                    }
+                }
+
+                _mm_storeu_si128(dst, blend4(pixels, _mm_loadu_si128(dst), premultiplied));
+            }
+        }
+#endif
+
+        for (; x < right; ++x, u += u_step) {
+            const uint32_t texel = texels[texelIndex(u >> 16, size.x, texture->repeated)];
+            store(modulate(texel, color), row[x]);
+        }
+    }
+}
+
+void SoftwareRenderBackend::drawTriangle(const Command& command, const sf::Vertex* triangle, const Band& band) {
+    const sf::Vector2f a = triangle[0].position;
+    const sf::Vector2f b = triangle[1].position;
+    const sf::Vector2f c = triangle[2].position;
+
+    const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (area == 0.f) {
+        return;
+    }
+
+    const int left = std::max(0, static_cast<int>(std::floor(std::min({ a.x, b.x, c.x }))));
+    const int right = std::min(static_cast<int>(m_size.x), static_cast<int>(std::ceil(std::max({ a.x, b.x, c.x }))));
+    const int top = std::max(band.top, static_cast<int>(std::floor(std::min({ a.y, b.y, c.y }))));
+    const int bottom = std::min(band.bottom, static_cast<int>(std::ceil(std::max({ a.y, b.y, c.y }))));
+
+    const uint32_t color = packColor(triangle[0].color);
+    const SoftTexture* texture = command.texture;
+
+    for (int y = top; y < bottom; ++y) {
+        uint32_t* row = &m_pixels[size_t(y) * m_size.x];
+        const float py = y + 0.5f;
+
+        for (int x = left; x < right; ++x) {
+            const float px = x + 0.5f;
+            const float w0 = ((b.x - px) * (c.y - py) - (b.y - py) * (c.x - px)) / area;
+            const float w1 = ((c.x - px) * (a.y - py) - (c.y - py) * (a.x - px)) / area;
+            const float w2 = 1.f - w0 - w1;
+
+            if (w0 < 0.f || w1 < 0.f || w2 < 0.f) {
+                continue;
+            }
+
+            uint32_t src = color;
+            if (texture) {
+                const float u = w0 * triangle[0].texCoords.x + w1 * triangle[1].texCoords.x + w2 * triangle[2].texCoords.x;
+                const float v = w0 * triangle[0].texCoords.y + w1 * triangle[1].texCoords.y + w2 * triangle[2].texCoords.y;
+                const int tx = texelIndex(static_cast<int>(std::floor(u)), texture->size.x, texture->repeated);
+                const int ty = texelIndex(static_cast<int>(std::floor(v)), texture->size.y, texture->repeated);
+                src = modulate(texture->pixels[size_t(ty) * texture->size.x + tx], color);
+            }
+
+            switch (command.blend) {
+            case Blend::NONE:
+                row[x] = src;
+                break;
+            case Blend::PREMULTIPLIED:
+                row[x] = blendPremultiplied(src, row[x]);
+                break;
+            default:
+                row[x] = blendAlpha(src, row[x]);
+                break;
+            }
+        }
+    }
+}
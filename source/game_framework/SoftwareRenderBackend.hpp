@@ -0,0 +1,127 @@
+#ifndef SOFTWARE_RENDER_BACKEND_HPP
+#define SOFTWARE_RENDER_BACKEND_HPP
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "RenderBackend.hpp"
+
+/// @brief CPU rasterizer backend rendering into a 32-bit RGBA framebuffer.
+///
+/// Draws are recorded during the frame and rasterised by finish(). Axis-aligned
+/// textured quads (sprites, tile chunks, glyphs, flipped or scaled) take the
+/// blit path with SSE2 alpha blending, anything else is rasterised as generic
+/// triangles. The framebuffer can be split into horizontal bands processed by
+/// worker threads, each band runs the whole command list clipped to itself,
+/// so the draw order is kept. Texture pixels are read back once per texture
+/// and cached, palette variants are separate textures already.
+class SoftwareRenderBackend : public RenderBackend {
+public:
+    explicit SoftwareRenderBackend(const sf::Vector2u& size, unsigned threads = 1);
+    ~SoftwareRenderBackend();
+
+    /*
+     * @brief Set number of bands rasterised in parallel, 1 - rasterise on caller thread
+     */
+    void setThreadCount(unsigned threads);
+
+    /*
+     * @brief Provide texture pixels to avoid reading them back from the texture
+     */
+    void setTextureImage(const sf::Texture& texture, const sf::Image& image);
+
+    /*
+     * @brief Drop cached pixels of a texture whose content has changed or which is freed
+     * @note Not during a frame, recorded draws refer to the cached pixels until finish()
+     */
+    void invalidateTexture(const sf::Texture& texture);
+
+    /*
+     * @brief Rasterise all draws recorded since the last clear()
+     */
+    void finish();
+
+    /*
+     * @brief Framebuffer pixels, RGBA bytes order, valid after finish()
+     */
+    const uint32_t* getPixels() const;
+    void copyToImage(sf::Image& image) const;
+
+    /*
+     * @brief Set view used as default, e.g. logical screen size bigger than the framebuffer
+     */
+    void setDefaultView(const sf::View& view);
+
+    void setView(const sf::View& view) override;
+    const sf::View& getView() const override;
+    const sf::View& getDefaultView() const override;
+    sf::Vector2u getSize() const override;
+
+protected:
+    void onClear(const sf::Color& color) override;
+    void onDrawVertices(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states) override;
+    void onDrawDrawable(const sf::Drawable& drawable, const sf::RenderStates& states) override;
+
+private:
+    struct SoftTexture {
+        sf::Vector2i size;
+        bool repeated = false;
+        std::vector<uint32_t> pixels;
+    };
+
+    enum class Blend : uint8_t {
+        ALPHA,
+        PREMULTIPLIED,
+        NONE
+    };
+
+    struct Command {
+        size_t first_vertex = 0;
+        size_t count = 0;
+        const SoftTexture* texture = nullptr;
+        Blend blend = Blend::ALPHA;
+    };
+
+    struct Band {
+        int top = 0;
+        int bottom = 0;
+    };
+
+    const SoftTexture* softTexture(const sf::Texture* texture);
+    sf::Transform pixelTransform(const sf::Transform& transform) const;
+    void record(const sf::Vertex* vertices, size_t count, const sf::RenderStates& states);
+
+    void rasterise(const Band& band);
+    void drawQuad(const Command& command, const sf::Vertex* quad, const Band& band);
+    void drawTriangle(const Command& command, const sf::Vertex* triangle, const Band& band);
+
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop(unsigned index, uint64_t generation);
+
+    sf::Vector2u m_size;
+    std::vector<uint32_t> m_pixels;
+    uint32_t m_clear_color = 0xff000000;
+    sf::View m_default_view;
+    sf::View m_view;
+
+    std::vector<sf::Vertex> m_vertices; //!< frame vertices, already in pixel space
+    std::vector<Command> m_commands;
+    std::unordered_map<const sf::Texture*, std::unique_ptr<SoftTexture>> m_textures;
+    bool m_unsupported_logged = false;
+
+    unsigned m_threads = 1;
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_start_cv;
+    std::condition_variable m_done_cv;
+    uint64_t m_frame_generation = 0;
+    unsigned m_busy_workers = 0;
+    bool m_stop = false;
+};
+
+#endif // SOFTWARE_RENDER_BACKEND_HPP
@@ -1,6 +1,8 @@
 #ifndef STATE_MACHINE_HPP
 #define STATE_MACHINE_HPP
 
+#include <array>
+#include <cstddef>
 #include <optional>
 #include <functional>
 #include <unordered_map>
@@ -112,6 +114,88 @@ private:
     std::unordered_map<StateT, std::vector<std::function<void()>> > m_onEnterActions;
 };
 
+/*
+ * @class TransitionTable
+ * @brief Transitions of an owner type, built once at compile time and shared by its instances
+ * @tparam Owner - class whose member functions are called as actions
+ * @tparam StateT - enum of states ending with COUNT, its values are table indexes
+ * @tparam EventT - enum of events ending with COUNT, its values are table indexes
+ *
+ * An instance keeps only its current state and passes itself to dispatchEvent,
+ * the transition is one (state x event) table cell. As in StateMachine the first
+ * transition added for a state and event wins, the state callback runs before
+ * the transition action.
+ */
+template <typename Owner, typename StateT, typename EventT>
+class TransitionTable {
+public:
+    static constexpr size_t STATES = static_cast<size_t>(StateT::COUNT);
+    static constexpr size_t EVENTS = static_cast<size_t>(EventT::COUNT);
+
+    using Action = void (Owner::*)();
+    using StateCallback = void (Owner::*)(StateT);
+
+    constexpr void addTransition(EventT event, StateT from, StateT to, Action action = nullptr) {
+        Cell& cell = m_cells[index(from)][index(event)];
+        if (!cell.valid) {
+            cell = { to, action, true };
+        }
+    }
+
+    constexpr void addTransition(EventT event, ANY_STATE_T, StateT to, Action action = nullptr) {
+        for (size_t from = 0; from < STATES; ++from) {
+            addTransition(event, static_cast<StateT>(from), to, action);
+        }
+    }
+
+    constexpr void setStateCallback(StateCallback callback) {
+        m_onState = callback;
+    }
+
+    void start(Owner& owner, StateT& state, StateT initialState) const {
+        enter(owner, state, initialState);
+    }
+
+    /*
+     * @brief Change instance state by the event and call the transition action
+     * @return false if the event has no transition from the current state
+     */
+    bool dispatchEvent(Owner& owner, StateT& state, EventT event) const {
+        const Cell& cell = m_cells[index(state)][index(event)];
+        if (!cell.valid) {
+            return false;
+        }
+
+        enter(owner, state, cell.to);
+        if (cell.action) {
+            (owner.*cell.action)();
+        }
+        return true;
+    }
+
+private:
+    struct Cell {
+        StateT to{};
+        Action action = nullptr;
+        bool valid = false;
+    };
+
+    template <typename E>
+    static constexpr size_t index(E value) {
+        return static_cast<size_t>(value);
+    }
+
+    void enter(Owner& owner, StateT& state, StateT to) const {
+        state = to;
+        if (m_onState) {
+            (owner.*m_onState)(to);
+        }
+    }
+
+    std::array<std::array<Cell, EVENTS>, STATES> m_cells{};
+    StateCallback m_onState = nullptr;
+};
+
 } // namespace fsm
 
 #endif // !STATE_MACHINE_HPP
@@ -0,0 +1,219 @@
+#include <algorithm>
+
+#include "Logger.hpp"
+#include "TextureAtlas.hpp"
+
+//---------------------------------------------------------------------------
+//! SkylinePacker
+//---------------------------------------------------------------------------
+SkylinePacker::SkylinePacker(unsigned width, unsigned height)
+    : m_width(width)
+    , m_height(height)
+    , m_skyline({ { 0, 0, width } }) {
+}
+
+bool SkylinePacker::fit(size_t index, const sf::Vector2u& size, unsigned& y) const {
+    const unsigned x = m_skyline[index].x;
+    if (x + size.x > m_width) {
+        return false;
+    }
+
+    // the rectangle rests on the highest node under it
+    y = 0;
+    unsigned width_left = size.x;
+    for (size_t i = index; width_left > 0; ++i) {
+        y = std::max(y, m_skyline[i].y);
+        if (y + size.y > m_height) {
+            return false;
+        }
+        width_left -= std::min(width_left, m_skyline[i].width);
+    }
+
+    return true;
+}
+
+std::optional<sf::Vector2u> SkylinePacker::insert(const sf::Vector2u& size) {
+    size_t best_index = m_skyline.size();
+    unsigned best_bottom = m_height + 1;
+    unsigned best_width = m_width + 1;
+    unsigned best_y = 0;
+
+    for (size_t i = 0; i < m_skyline.size(); ++i) {
+        unsigned y = 0;
+        if (!fit(i, size, y)) {
+            continue;
+        }
+
+        const unsigned bottom = y + size.y;
+        if (bottom < best_bottom || (bottom == best_bottom && m_skyline[i].width < best_width)) {
+            best_index = i;
+            best_bottom = bottom;
+            best_width = m_skyline[i].width;
+            best_y = y;
+        }
+    }
+
+    if (best_index == m_skyline.size()) {
+        return std::nullopt;
+    }
+
+    const unsigned x = m_skyline[best_index].x;
+    m_skyline.insert(m_skyline.begin() + best_index, { x, best_y + size.y, size.x });
+
+    // nodes covered by the new one are cut or removed
+    for (size_t i = best_index + 1; i < m_skyline.size();) {
+        Node& node = m_skyline[i];
+        const unsigned covered_to = x + size.x;
+        if (node.x >= covered_to) {
+            break;
+        }
+
+        const unsigned shrink = covered_to - node.x;
+        if (shrink >= node.width) {
+            m_skyline.erase(m_skyline.begin() + i);
+            continue;
+        }
+
+        node.x += shrink;
+        node.width -= shrink;
+        break;
+    }
+
+    // neighbours of the same height are merged
+    for (size_t i = 0; i + 1 < m_skyline.size();) {
+        if (m_skyline[i].y == m_skyline[i + 1].y) {
+            m_skyline[i].width += m_skyline[i + 1].width;
+            m_skyline.erase(m_skyline.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+
+    m_used_area += size_t(size.x) * size.y;
+    return sf::Vector2u(x, best_y);
+}
+
+unsigned SkylinePacker::usedHeight() const {
+    unsigned height = 0;
+    for (const Node& node : m_skyline) {
+        height = std::max(height, node.y);
+    }
+    return height;
+}
+
+size_t SkylinePacker::usedArea() const {
+    return m_used_area;
+}
+
+//---------------------------------------------------------------------------
+//! TextureAtlas
+//---------------------------------------------------------------------------
+bool TextureAtlas::build(const std::vector<std::pair<std::string, const sf::Texture*>>& sources,
+                         unsigned page_size, unsigned padding) {
+    m_pages.clear();
+    m_regions.clear();
+    m_stats = Stats();
+
+    page_size = std::min(page_size, sf::Texture::getMaximumSize());
+
+    struct Placement {
+        const sf::Texture* texture;
+        size_t page;
+        sf::Vector2u position;
+    };
+
+    // the tallest first, a classic order for skyline packing
+    std::vector<std::pair<std::string, const sf::Texture*>> order;
+    for (const auto& source : sources) {
+        if (!source.second) {
+            continue;
+        }
+        if (source.second->isRepeated() || source.second->isSmooth()) {
+            // a page can't take over sampling settings of one source
+            LOG("ATLAS", WARNING, "%s is repeated or smooth, not packed", source.first.c_str());
+            continue;
+        }
+        order.push_back(source);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        return a.second->getSize().y > b.second->getSize().y;
+    });
+
+    std::vector<SkylinePacker> packers;
+    std::vector<Placement> placements;
+
+    for (const auto& [name, texture] : order) {
+        const sf::Vector2u size(texture->getSize().x + padding, texture->getSize().y + padding);
+        if (size.x > page_size || size.y > page_size) {
+            LOG("ATLAS", WARNING, "%s doesn't fit in a %u page, not packed", name.c_str(), page_size);
+            continue;
+        }
+
+        std::optional<sf::Vector2u> position;
+        size_t page = 0;
+        for (; page < packers.size() && !position; ++page) {
+            position = packers[page].insert(size);
+        }
+
+        if (!position) {
+            packers.emplace_back(page_size, page_size);
+            page = packers.size();
+            position = packers.back().insert(size);
+        }
+
+        placements.push_back({ texture, page - 1, *position });
+    }
+
+    // pages are cut to the used height, the width stays for the next build
+    for (size_t page = 0; page < packers.size(); ++page) {
+        const unsigned height = std::max(4u, (packers[page].usedHeight() + 3) & ~3u);
+        sf::Image image({ page_size, height }, sf::Color::Transparent);
+
+        for (const Placement& placement : placements) {
+            if (placement.page == page) {
+                image.copy(placement.texture->copyToImage(), placement.position);
+            }
+        }
+
+        auto texture = std::make_unique<sf::Texture>();
+        if (!texture->loadFromImage(image)) {
+            LOG("ATLAS", ERROR, "Failed to create %ux%u atlas page", page_size, height);
+            m_pages.clear();
+            m_regions.clear();
+            return false;
+        }
+
+        m_stats.page_pixels += size_t(page_size) * height;
+        m_pages.push_back(std::move(texture));
+    }
+
+    for (const Placement& placement : placements) {
+        const sf::Vector2u size = placement.texture->getSize();
+        m_regions[placement.texture] = { m_pages[placement.page].get(), sf::Vector2f(placement.position) };
+        m_stats.used_pixels += size_t(size.x) * size.y;
+    }
+
+    m_stats.pages = m_pages.size();
+    m_stats.sources = placements.size();
+    m_stats.occupancy = m_stats.page_pixels ? (float)m_stats.used_pixels / m_stats.page_pixels : 0.f;
+    return !m_pages.empty();
+}
+
+const TextureAtlas::Region* TextureAtlas::find(const sf::Texture* texture) const {
+    if (m_regions.empty()) {
+        return nullptr;
+    }
+
+    auto it = m_regions.find(texture);
+    return (it != m_regions.end()) ? &it->second : nullptr;
+}
+
+TextureAtlas::Stats TextureAtlas::getStats() const {
+    return m_stats;
+}
+
+void TextureAtlas::logStats() const {
+    LOG("ATLAS", INFO, "%zu textures in %zu pages, %.1f of %.1f Mpx used, occupancy %.0f%%",
+        m_stats.sources, m_stats.pages, m_stats.used_pixels / 1e6f, m_stats.page_pixels / 1e6f,
+        m_stats.occupancy * 100.f);
+}
@@ -0,0 +1,90 @@
+#ifndef TEXTURE_ATLAS_HPP
+#define TEXTURE_ATLAS_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+/// @brief Skyline bottom-left rectangle packer.
+///
+/// The skyline is the upper contour of placed rectangles; a new one goes to
+/// the lowest position where it fits, ties are resolved by the least width.
+class SkylinePacker {
+public:
+    SkylinePacker(unsigned width, unsigned height);
+
+    /*
+     * @brief Reserve a rectangle
+     * @return left top corner, nothing if there is no space left
+     */
+    std::optional<sf::Vector2u> insert(const sf::Vector2u& size);
+
+    unsigned usedHeight() const;    //!< the highest point of the skyline
+    size_t usedArea() const;        //!< sum of inserted rectangles
+
+private:
+    struct Node {
+        unsigned x;
+        unsigned y;
+        unsigned width;
+    };
+
+    bool fit(size_t index, const sf::Vector2u& size, unsigned& y) const;
+
+    unsigned m_width;
+    unsigned m_height;
+    std::vector<Node> m_skyline;
+    size_t m_used_area = 0;
+};
+
+/// @brief Sprite textures packed into one or a few large pages at load time.
+///
+/// Source textures stay as they are, Renderer looks up every batched draw
+/// here and swaps the texture for the page with the rect moved by the
+/// region offset, so call sites keep using source textures and rects.
+/// Sprites from different sources then end up in one batch.
+class TextureAtlas {
+public:
+    struct Region {
+        const sf::Texture* page = nullptr;
+        sf::Vector2f offset;
+    };
+
+    struct Stats {
+        size_t pages = 0;
+        size_t sources = 0;
+        size_t used_pixels = 0;     //!< source textures
+        size_t page_pixels = 0;     //!< all pages
+        float occupancy = 0.f;      //!< used / page pixels
+    };
+
+    /*
+     * @brief Pack textures, previous pages are dropped
+     * @param sources [in] - name and texture, sources which don't fit in a page are left out
+     * @param page_size [in] - page width and maximum height, clamped to the GPU limit
+     * @param padding [in] - gap between sources against sampling the neighbour
+     * @return false if no page could be created
+     */
+    bool build(const std::vector<std::pair<std::string, const sf::Texture*>>& sources,
+               unsigned page_size = 2048, unsigned padding = 2);
+
+    /*
+     * @brief Region of a source texture
+     * @return nullptr if the texture isn't packed
+     */
+    const Region* find(const sf::Texture* texture) const;
+
+    Stats getStats() const;
+    void logStats() const;
+
+private:
+    std::vector<std::unique_ptr<sf::Texture>> m_pages;
+    std::unordered_map<const sf::Texture*, Region> m_regions;
+    Stats m_stats;
+};
+
+#endif // TEXTURE_ATLAS_HPP
@@ -1,54 +1,157 @@
+#include <algorithm>
+
 #include "TimerManager.hpp"
 
-int TimerManager::setTimer(const std::function <void()>& func, int delay) {
-    TimerData timer_data;
-    timer_data.id = m_last_id++;
-    timer_data.remain_time = delay;
-    timer_data.func = func;
-    m_invoke_list.push_back(timer_data);
-    return timer_data.id;
+TimerManager::Handle TimerManager::schedule(TimerCallback callback, int delay) {
+    uint32_t index = m_free;
+    if (index != NONE) {
+        m_free = m_timers[index].next;
+    } else {
+        index = static_cast<uint32_t>(m_timers.size());
+        m_timers.emplace_back();
+    }
+
+    Timer& timer = m_timers[index];
+    timer.callback = std::move(callback);
+    // the earliest is the next processed tick, as a timer without delay used to fire on the next update.
+    // While a tick is expiring its slot is already drained, so the tick after it
+    const uint64_t earliest = m_expiring ? m_next_tick + 1 : m_next_tick;
+    timer.expires = std::max<uint64_t>(m_time + std::max(delay, 0), earliest);
+    insert(index);
+
+    return (Handle(timer.generation) << 32) | index;
 }
 
 void TimerManager::update(int delta_time) {
-    if (m_paused) {
+    if (m_paused || delta_time <= 0) {
         return;
     }
 
-    for (auto it = m_invoke_list.begin(); it != m_invoke_list.end();) {
-        it->remain_time -= delta_time;
+    m_time += delta_time;
+    for (; m_next_tick <= m_time; ++m_next_tick) {
+        // entering a new range of a level, redistribute its timers to the finer ones
+        for (unsigned level = 1; level < LEVELS; ++level) {
+            if (m_next_tick & ((uint64_t(1) << (LEVEL_BITS * level)) - 1)) {
+                break;
+            }
+            cascade(level);
+        }
 
-        if (it->remain_time <= 0) {
-            it->func();
-            it = m_invoke_list.erase(it);
-        } else {
-            ++it;
+        const uint32_t bucket = m_next_tick & (SLOTS - 1);
+        if (m_buckets[bucket] != NONE) {
+            m_buckets[EXPIRING] = std::exchange(m_buckets[bucket], NONE);
+            for (uint32_t index = m_buckets[EXPIRING]; index != NONE; index = m_timers[index].next) {
+                m_timers[index].bucket = EXPIRING;
+            }
+            invokeExpiring();
         }
     }
 }
 
-float TimerManager::getTimerRemaining(int handle) const {
-    auto it = std::find_if(m_invoke_list.begin(), m_invoke_list.end(), [handle](const TimerData& data)
-        {
-            return data.id == handle;
-        });
-
-    if (it != m_invoke_list.end()) {
-        return it->remain_time;
+float TimerManager::getTimerRemaining(Handle handle) const {
+    const Timer* timer = find(handle);
+    if (!timer) {
+        return -1;
     }
 
-    return -1;
+    return timer->expires > m_time ? float(timer->expires - m_time) : 0.f;
 }
 
-void TimerManager::clearTimer(int id) {
-    auto it = std::find_if(m_invoke_list.begin(), m_invoke_list.end(), [id](const TimerData& data) {
-            return data.id == id;
-        });
-
-    if (it != m_invoke_list.end()) {
-        m_invoke_list.erase(it);
+void TimerManager::clearTimer(Handle handle) {
+    if (find(handle)) {
+        const uint32_t index = static_cast<uint32_t>(handle);
+        unlink(index);
+        release(index);
     }
 }
 
 void TimerManager::setPause(bool paused) {
     m_paused = paused;
 }
+
+TimerManager::Timer* TimerManager::find(Handle handle) {
+    return const_cast<Timer*>(std::as_const(*this).find(handle));
+}
+
+const TimerManager::Timer* TimerManager::find(Handle handle) const {
+    const uint32_t index = static_cast<uint32_t>(handle);
+    if (index >= m_timers.size()) {
+        return nullptr;
+    }
+
+    const Timer& timer = m_timers[index];
+    return (timer.bucket != NONE && timer.generation == uint32_t(handle >> 32)) ? &timer : nullptr;
+}
+
+void TimerManager::insert(uint32_t index) {
+    const uint64_t expires = m_timers[index].expires;
+    const uint64_t delta = expires - m_next_tick;
+
+    unsigned level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t(1) << (LEVEL_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    // too far for the wheel, parked in the last slot reachable and inserted again from there
+    const uint64_t range = uint64_t(1) << (LEVEL_BITS * LEVELS);
+    const uint64_t tick = (delta < range) ? expires : m_next_tick + range - 1;
+    const uint32_t slot = (tick >> (LEVEL_BITS * level)) & (SLOTS - 1);
+    link(index, level * SLOTS + slot);
+}
+
+void TimerManager::link(uint32_t index, uint32_t bucket) {
+    Timer& timer = m_timers[index];
+    timer.bucket = bucket;
+    timer.prev = NONE;
+    timer.next = m_buckets[bucket];
+    if (timer.next != NONE) {
+        m_timers[timer.next].prev = index;
+    }
+    m_buckets[bucket] = index;
+}
+
+void TimerManager::unlink(uint32_t index) {
+    Timer& timer = m_timers[index];
+    if (timer.prev != NONE) {
+        m_timers[timer.prev].next = timer.next;
+    } else {
+        m_buckets[timer.bucket] = timer.next;
+    }
+    if (timer.next != NONE) {
+        m_timers[timer.next].prev = timer.prev;
+    }
+    timer.bucket = NONE;
+}
+
+void TimerManager::release(uint32_t index) {
+    Timer& timer = m_timers[index];
+    timer.callback.reset();
+    timer.bucket = NONE;
+    ++timer.generation;
+    timer.next = m_free;
+    m_free = index;
+}
+
+void TimerManager::cascade(unsigned level) {
+    const uint32_t slot = (m_next_tick >> (LEVEL_BITS * level)) & (SLOTS - 1);
+    uint32_t index = std::exchange(m_buckets[level * SLOTS + slot], NONE);
+    while (index != NONE) {
+        const uint32_t next = m_timers[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+void TimerManager::invokeExpiring() {
+    // callbacks may set and clear timers, the expiring one included
+    m_expiring = true;
+    while (m_buckets[EXPIRING] != NONE) {
+        const uint32_t index = m_buckets[EXPIRING];
+        unlink(index);
+
+        TimerCallback callback = std::move(m_timers[index].callback);
+        release(index);
+        callback();
+    }
+    m_expiring = false;
+}
@@ -1,35 +1,154 @@
 #ifndef TIMER_MANAGER_HPP
 #define TIMER_MANAGER_HPP
 
-#include <functional>
-#include <list>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+/// @brief void() callable stored in place, it never allocates.
+class TimerCallback {
+public:
+    static constexpr size_t CAPACITY = 48;
+
+    TimerCallback() = default;
+
+    template <typename F>
+        requires (!std::is_same_v<std::decay_t<F>, TimerCallback>)
+    TimerCallback(F&& func) {
+        using T = std::decay_t<F>;
+        static_assert(sizeof(T) <= CAPACITY && alignof(T) <= alignof(std::max_align_t),
+                      "timer callable doesn't fit inline storage, capture less");
+        new (m_storage) T(std::forward<F>(func));
+        m_ops = &OPS<T>;
+    }
+
+    TimerCallback(TimerCallback&& other) noexcept {
+        moveFrom(other);
+    }
+
+    TimerCallback& operator=(TimerCallback&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~TimerCallback() {
+        reset();
+    }
+
+    void operator()() {
+        m_ops->invoke(m_storage);
+    }
+
+    explicit operator bool() const {
+        return m_ops != nullptr;
+    }
+
+    void reset() {
+        if (m_ops) {
+            m_ops->destroy(m_storage);
+            m_ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* callable);
+        void (*move)(void* to, void* from);  //!< also destroys the source
+        void (*destroy)(void* callable);
+    };
+
+    template <typename T>
+    static constexpr Ops OPS = {
+        [](void* callable) { (*static_cast<T*>(callable))(); },
+        [](void* to, void* from) {
+            new (to) T(std::move(*static_cast<T*>(from)));
+            static_cast<T*>(from)->~T();
+        },
+        [](void* callable) { static_cast<T*>(callable)->~T(); }
+    };
+
+    void moveFrom(TimerCallback& other) {
+        if (other.m_ops) {
+            other.m_ops->move(m_storage, other.m_storage);
+            m_ops = std::exchange(other.m_ops, nullptr);
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char m_storage[CAPACITY];
+    const Ops* m_ops = nullptr;
+};
+
+/// @brief Delayed calls on a hierarchical timing wheel with 1 ms ticks.
+///
+/// Timers are kept in buckets by expiry tick, the near ones by the tick and
+/// the far ones by coarser ranges, which are redistributed as time comes to
+/// them. An update only visits the buckets of the ticks it passes, so its
+/// cost doesn't depend on the number of pending timers. Timers live in a
+/// pool and are addressed by generational handles, a handle of a fired or
+/// cleared timer just doesn't match anymore.
 class TimerManager {
 public:
-    int setTimer(const std::function <void()>& func, int delay);
+    using Handle = uint64_t;   //!< 0 - no timer
+
+    template <typename F>
+    Handle setTimer(F&& func, int delay) {
+        return schedule(TimerCallback(std::forward<F>(func)), delay);
+    }
 
     template<typename Class, typename ...Args>
-    int setTimer(Class* object, void (Class::* func)(Args...), int delay, Args... args) {
+    Handle setTimer(Class* object, void (Class::* func)(Args...), int delay, Args... args) {
         return setTimer([object, func, args...]() { (object->*func)(args...); }, delay);
     }
 
-    float getTimerRemaining(int handle) const;
-    void clearTimer(int id);
+    /*
+     * @brief Time left before the timer fires, in ms
+     * @return -1 if the timer has fired or was cleared
+     */
+    float getTimerRemaining(Handle handle) const;
+    void clearTimer(Handle handle);
 
     void update(int delta_time);
     void setPause(bool paused);
 
 private:
+    static constexpr unsigned LEVEL_BITS = 6;
+    static constexpr unsigned LEVELS = 4;        //!< up to 2^24 ms, later timers wait in the last level
+    static constexpr uint32_t SLOTS = 1u << LEVEL_BITS;
+    static constexpr uint32_t EXPIRING = LEVELS * SLOTS;  //!< bucket being invoked
+    static constexpr uint32_t NONE = UINT32_MAX;
 
-    struct TimerData {
-        int id;
-        int remain_time;
-        std::function<void()> func;
+    struct Timer {
+        TimerCallback callback;
+        uint64_t expires = 0;       //!< tick
+        uint32_t generation = 1;
+        uint32_t bucket = NONE;     //!< NONE - free
+        uint32_t prev = NONE;
+        uint32_t next = NONE;       //!< also links free timers
     };
 
-    int m_last_id = 0;
+    Handle schedule(TimerCallback callback, int delay);
+    Timer* find(Handle handle);
+    const Timer* find(Handle handle) const;
+    void insert(uint32_t index);
+    void link(uint32_t index, uint32_t bucket);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(unsigned level);
+    void invokeExpiring();
+
+    std::vector<Timer> m_timers;
+    std::vector<uint32_t> m_buckets = std::vector<uint32_t>(EXPIRING + 1, NONE);  //!< list heads
+    uint32_t m_free = NONE;
+    uint64_t m_time = 0;        //!< ms passed, pauses excluded
+    uint64_t m_next_tick = 1;   //!< first tick not processed yet
     bool m_paused = false;
-    std::list<TimerData> m_invoke_list;
+    bool m_expiring = false;    //!< callbacks of m_next_tick are invoked
 };
 
 #endif // !TIMER_MANAGER_HPP
@@ -0,0 +1,121 @@
+#include <algorithm>
+
+#include "Logger.hpp"
+#include "VoiceManager.hpp"
+
+VoiceManager::VoiceManager(size_t voices) {
+    m_voices.reserve(voices);
+    for (size_t i = 0; i < voices; ++i) {
+        m_voices.emplace_back(m_silence);
+    }
+    m_stats.voices = voices;
+}
+
+void VoiceManager::setSettings(const sf::SoundBuffer* buffer, const Settings& settings) {
+    if (buffer) {
+        m_settings[buffer] = settings;
+    }
+}
+
+void VoiceManager::nextTick() {
+    ++m_tick;
+}
+
+bool VoiceManager::play(const sf::SoundBuffer& buffer) {
+    auto it = m_settings.find(&buffer);
+    const Settings settings = (it != m_settings.end()) ? it->second : Settings();
+
+    Voice* free_voice = nullptr;
+    Voice* oldest_same = nullptr;
+    Voice* victim = nullptr;
+    unsigned same_count = 0;
+
+    for (Voice& voice : m_voices) {
+        if (!isPlaying(voice)) {
+            if (!free_voice) {
+                free_voice = &voice;
+            }
+            continue;
+        }
+
+        if (voice.buffer == &buffer) {
+            if (voice.started_tick == m_tick) {
+                // e.g. several enemies kicked at once, one sound is enough
+                ++m_stats.merged;
+                return true;
+            }
+
+            ++same_count;
+            if (!oldest_same || voice.started_order < oldest_same->started_order) {
+                oldest_same = &voice;
+            }
+        }
+
+        if (voice.priority <= settings.priority &&
+            (!victim || voice.priority < victim->priority ||
+             (voice.priority == victim->priority && voice.started_order < victim->started_order))) {
+            victim = &voice;
+        }
+    }
+
+    if (settings.max_voices && same_count >= settings.max_voices) {
+        ++m_stats.limited;
+        start(*oldest_same, buffer, settings.priority);
+        return true;
+    }
+
+    if (free_voice) {
+        start(*free_voice, buffer, settings.priority);
+        return true;
+    }
+
+    if (victim) {
+        ++m_stats.steals;
+        start(*victim, buffer, settings.priority);
+        return true;
+    }
+
+    ++m_stats.drops;
+    return false;
+}
+
+void VoiceManager::stopAll() {
+    for (Voice& voice : m_voices) {
+        voice.sound.stop();
+    }
+}
+
+VoiceManager::Stats VoiceManager::getStats() const {
+    m_stats.in_use = std::count_if(m_voices.begin(), m_voices.end(), [this](const Voice& voice) {
+        return isPlaying(voice);
+    });
+    return m_stats;
+}
+
+void VoiceManager::logStats() const {
+    const Stats stats = getStats();
+    LOG("VOICES", INFO, "%zu/%zu voices in use, peak %zu. Played %zu, merged %zu, limited %zu, steals %zu, drops %zu",
+        stats.in_use, stats.voices, stats.peak_in_use, stats.played, stats.merged, stats.limited, stats.steals, stats.drops);
+}
+
+bool VoiceManager::isPlaying(const Voice& voice) const {
+    return voice.buffer && voice.sound.getStatus() == sf::SoundSource::Status::Playing;
+}
+
+void VoiceManager::start(Voice& voice, const sf::SoundBuffer& buffer, int priority) {
+    voice.sound.stop();
+    if (voice.buffer != &buffer) {
+        voice.sound.setBuffer(buffer);
+        voice.buffer = &buffer;
+    }
+    voice.priority = priority;
+    voice.started_tick = m_tick;
+    voice.started_order = ++m_order;
+    voice.sound.play();
+
+    ++m_stats.played;
+    const size_t in_use = std::count_if(m_voices.begin(), m_voices.end(), [this](const Voice& other) {
+        return isPlaying(other);
+    });
+    m_stats.peak_in_use = std::max(m_stats.peak_in_use, in_use);
+}
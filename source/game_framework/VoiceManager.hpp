@@ -0,0 +1,84 @@
+#ifndef VOICE_MANAGER_HPP
+#define VOICE_MANAGER_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <SFML/Audio.hpp>
+
+/// @brief Fixed pool of sound voices.
+///
+/// Voices are created once and reused with another buffer, playing a sound
+/// allocates nothing. The same sound requested again in one tick is merged
+/// into the voice already started. Each sound may limit its concurrent
+/// voices, the oldest one is restarted then. When every voice is busy, the
+/// oldest voice of the lowest priority not above the new sound is stolen,
+/// otherwise the new sound is dropped.
+class VoiceManager {
+public:
+    struct Settings {
+        int priority = 0;          //!< higher steals lower
+        unsigned max_voices = 0;   //!< concurrent voices of this sound, 0 - unlimited
+    };
+
+    struct Stats {
+        size_t voices = 0;
+        size_t in_use = 0;         //!< playing now
+        size_t peak_in_use = 0;
+        size_t played = 0;
+        size_t merged = 0;         //!< repeated in the same tick
+        size_t limited = 0;        //!< restarted over max_voices
+        size_t steals = 0;         //!< took a voice of another sound
+        size_t drops = 0;          //!< no voice of lower or equal priority
+    };
+
+    explicit VoiceManager(size_t voices = 32);
+
+    VoiceManager(const VoiceManager&) = delete;
+    VoiceManager& operator=(const VoiceManager&) = delete;
+
+    /*
+     * @brief Priority and concurrency of a sound, sounds without settings use the default ones
+     */
+    void setSettings(const sf::SoundBuffer* buffer, const Settings& settings);
+
+    /*
+     * @brief Start a new tick, sounds played from now on aren't merged with the previous ones
+     */
+    void nextTick();
+
+    /*
+     * @brief Play sound on a free or stolen voice
+     * @return false if the sound was dropped
+     */
+    bool play(const sf::SoundBuffer& buffer);
+
+    void stopAll();
+
+    Stats getStats() const;
+    void logStats() const;
+
+private:
+    struct Voice {
+        explicit Voice(const sf::SoundBuffer& buffer) : sound(buffer) {}
+
+        sf::Sound sound;
+        const sf::SoundBuffer* buffer = nullptr;
+        int priority = 0;
+        uint64_t started_tick = 0;
+        uint64_t started_order = 0;   //!< play() counter, orders voices by age
+    };
+
+    bool isPlaying(const Voice& voice) const;
+    void start(Voice& voice, const sf::SoundBuffer& buffer, int priority);
+
+    sf::SoundBuffer m_silence;      //!< initial buffer of idle voices
+    std::vector<Voice> m_voices;
+    std::unordered_map<const sf::SoundBuffer*, Settings> m_settings;
+    uint64_t m_tick = 1;
+    uint64_t m_order = 0;
+    mutable Stats m_stats;
+};
+
+#endif // VOICE_MANAGER_HPP
@@ -1,7 +1,97 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
 #include "SuperMarioGame.hpp"
 
+namespace {
+   struct Options {
+      bool measure_startup = false;
+      size_t memory_budget_mb = 0;
+      bool headless = false;
+      int frames = 600;
+      std::string capture_path;
+      unsigned every_nth = 1;
+      bool software = false;
+   };
+
+   // flag values are the arguments following it up to the next flag
+   bool hasValue(int index, int argc, char* argv[]) {
+      return index < argc && strncmp(argv[index], "--", 2) != 0;
+   }
+
+   // flags may come in any order and be combined, each consumes its own values
+   Options parseOptions(int argc, char* argv[]) {
+      Options options;
+      for (int i = 1; i < argc; ++i) {
+         const char* flag = argv[i];
+         if (!strcmp(flag, "--measure-startup")) {
+            options.measure_startup = true;
+         } else if (!strcmp(flag, "--memory-budget") && hasValue(i + 1, argc, argv)) {
+            options.memory_budget_mb = size_t(atoi(argv[++i]));
+         } else if (!strcmp(flag, "--headless")) {
+            options.headless = true;
+            if (hasValue(i + 1, argc, argv)) {
+               options.frames = atoi(argv[++i]);
+            }
+            if (hasValue(i + 1, argc, argv)) {
+               options.capture_path = argv[++i];
+            }
+            if (hasValue(i + 1, argc, argv)) {
+               options.every_nth = atoi(argv[++i]);
+            }
+         } else if (!strcmp(flag, "--software")) {
+            options.software = true;
+         } else if (!strcmp(flag, "--capture") && hasValue(i + 1, argc, argv)) {
+            options.capture_path = argv[++i];
+            if (hasValue(i + 1, argc, argv)) {
+               options.every_nth = atoi(argv[++i]);
+            }
+         } else {
+            LOG("MAIN", WARNING, "Unknown argument %s", flag);
+         }
+      }
+      return options;
+   }
+}
 
 int main(int argc, char* argv[]) {
+   // --measure-startup: load all assets, report per asset decode and upload times and exit
+   // --memory-budget MB: evict textures nobody uses above this size
+   // --headless [frames] [capture.png | frame_%05d.png [every]]: no window, render statistics and
+   //    optionally the last CPU rendered frame or every Nth one
+   // --software: CPU rasterizer at 1280x720/1.5, for machines without GPU
+   // --capture frame_%05d.png [every]: write every Nth frame, of the CPU rasterizer with --software
+   const Options options = parseOptions(argc, argv);
+
+   if (options.measure_startup) {
+      const auto start = std::chrono::steady_clock::now();
+      MarioGame* game = MarioGame::instance();
+      const float total_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+      game->startupReport().log();
+      game->logResourceStats();
+      LOG("MAIN", INFO, "Game constructed in %.1f ms", total_ms);
+      return 0;
+   }
+
+   if (options.memory_budget_mb) {
+      MarioGame::instance()->textureManager().setMemoryBudget(options.memory_budget_mb << 20);
+   }
+
+   if (options.headless) {
+      MarioGame::instance()->runHeadless(options.frames, options.capture_path, options.every_nth);
+      return 0;
+   }
+
+   if (options.software) {
+      MarioGame::instance()->setSoftwareRendering(true, 1.5f);
+   }
+
+   if (!options.capture_path.empty()) {
+      MarioGame::instance()->setFrameCapture(options.capture_path, options.every_nth);
+   }
+
    MarioGame::instance()->run();
    return 0;
 }
@@ -11,9 +11,9 @@ Coin::Coin() {
     rot_offset += 0.4f;
 }
 
-void Coin::draw(sf::RenderWindow* render_window) {
+void Coin::draw(Renderer* renderer) {
     m_animator.setPosition(getPosition());
-    m_animator.draw(render_window);
+    m_animator.draw(renderer);
 }
 
 void Coin::update(int delta_time) {
@@ -42,7 +42,7 @@ void Coin::kick() {
     MARIO_GAME.addScore(100);
     MARIO_GAME.addCoin();
     MARIO_GAME.playSound("coin");
-    MARIO_GAME.spawnObject<TwistedCoin>(getPosition() + Vector::UP * 32);
+    spawnTwistedCoin(getPosition() + Vector::UP * 32);
     removeLater();
 }
 
@@ -7,7 +7,7 @@ class Coin : public GameObject {
 
 public:
     Coin();
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void kick();
 
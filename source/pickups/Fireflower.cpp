@@ -10,9 +10,9 @@ FireFlower::FireFlower(const Vector& pos)
     setPosition(pos.x, pos.y + 32);
 }
 
-void FireFlower::draw(sf::RenderWindow* render_window) {
+void FireFlower::draw(Renderer* renderer) {
     m_sprite.setPosition(getPosition());
-    render_window->draw(m_sprite);
+    renderer->draw(m_sprite);
 }
 
 void FireFlower::update(int delta_time) {
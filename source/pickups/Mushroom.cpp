@@ -11,9 +11,9 @@ Mushroom::Mushroom(const Vector& pos)
     setPosition(pos.x, pos.y + 32);
 }
 
-void Mushroom::draw(sf::RenderWindow* render_window) {
+void Mushroom::draw(Renderer* renderer) {
     m_sprite.setPosition(getPosition());
-    render_window->draw(m_sprite);
+    renderer->draw(m_sprite);
 }
 
 void Mushroom::update(int delta_time) {
@@ -7,7 +7,7 @@ class Mushroom : public GameObject {
 
 public:
     Mushroom(const Vector& pos);
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
     void kick();
 
@@ -12,9 +12,9 @@ Star::Star(const Vector& pos)
     m_speed.x = HORIZONTAL_SPEED;
 }
 
-void Star::draw(sf::RenderWindow* render_window) {
+void Star::draw(Renderer* renderer) {
     m_sprite.setPosition(getPosition());
-    render_window->draw(m_sprite);
+    renderer->draw(m_sprite);
 }
 
 void Star::onStarted() {
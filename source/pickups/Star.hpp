@@ -5,7 +5,7 @@
 class Star : public GameObject {
 public:
     Star(const Vector& pos);
-    void draw(sf::RenderWindow* render_window) override;
+    void draw(Renderer* renderer) override;
     void update(int delta_time) override;
 
 private:
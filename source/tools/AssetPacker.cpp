@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <AssetPack.hpp>
+
+// asset-packer <res dir> <output file>
+//     packs textures, fonts, sounds and music into one archive, levels are compiled separately
+// asset-packer --list <pack file>
+//     prints pack entries
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const PACKED_DIRS[] = { "Textures", "Fonts", "Sounds", "Music" };
+
+bool readFile(const fs::path& path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+int packAssets(const fs::path& res_dir, const fs::path& output) {
+    pack::AssetPackBuilder builder;
+    size_t files = 0;
+    size_t bytes = 0;
+
+    for (const char* dir : PACKED_DIRS) {
+        if (!fs::is_directory(res_dir / dir)) {
+            std::fprintf(stderr, "asset-packer: no %s directory, skipped\n", dir);
+            continue;
+        }
+
+        std::vector<fs::path> paths;
+        for (const auto& entry : fs::recursive_directory_iterator(res_dir / dir)) {
+            if (entry.is_regular_file()) {
+                paths.push_back(entry.path());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+
+        for (const auto& path : paths) {
+            std::vector<uint8_t> data;
+            if (!readFile(path, data)) {
+                std::fprintf(stderr, "asset-packer: can't read %s\n", path.string().c_str());
+                return EXIT_FAILURE;
+            }
+
+            // entry names are the paths the game uses relative to res/
+            const std::string name = fs::relative(path, res_dir).generic_string();
+            bytes += data.size();
+            builder.add(name, std::move(data));
+            ++files;
+        }
+    }
+
+    const std::vector<uint8_t> data = builder.build();
+    std::ofstream file(output, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!file) {
+        std::fprintf(stderr, "asset-packer: can't write %s\n", output.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::printf("%zu files, %zu bytes -> %s, %zu bytes\n", files, bytes, output.string().c_str(), data.size());
+    return EXIT_SUCCESS;
+}
+
+int listPack(const fs::path& path) {
+    AssetPack pack;
+    if (!pack.open(path.string())) {
+        std::fprintf(stderr, "asset-packer: %s isn't a valid pack\n", path.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < pack.entryCount(); ++i) {
+        const std::string name(pack.entryName(i));
+        std::printf("%10zu  %s\n", pack.entryData(i).size(), name.c_str());
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 2 && !std::strcmp(argv[1], "--list")) {
+        return listPack(argv[2]);
+    }
+
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: asset-packer <res dir> <output file>\n"
+                             "       asset-packer --list <pack file>\n");
+        return EXIT_FAILURE;
+    }
+
+    return packAssets(argv[1], argv[2]);
+}
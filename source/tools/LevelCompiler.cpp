@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "tinyxml2.h"
+
+#include <Format.hpp>
+#include <LevelFormat.hpp>
+
+// level-compiler <levels dir> [output dir]
+//     converts every .tmx to .lvl, output defaults to the levels dir
+// level-compiler --benchmark <levels dir> [iterations]
+//     compares loading .tmx with mapping the compiled files, compile them first
+// level-compiler --parse-benchmark <levels dir> [iterations]
+//     splits .tmx loading into file read, xml parse and tile layer parse
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<fs::path> findLevels(const fs::path& dir) {
+    std::vector<fs::path> levels;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".tmx") {
+            levels.push_back(entry.path());
+        }
+    }
+    std::sort(levels.begin(), levels.end());
+    return levels;
+}
+
+int compileLevels(const fs::path& input_dir, const fs::path& output_dir) {
+    std::error_code ec;
+    fs::create_directories(output_dir, ec);
+
+    int failed = 0;
+    for (const auto& tmx : findLevels(input_dir)) {
+        std::vector<uint8_t> data;
+        std::string error;
+
+        if (!level::compileTmx(tmx.string(), data, &error)) {
+            std::fprintf(stderr, "level-compiler: %s: %s\n", tmx.string().c_str(), error.c_str());
+            ++failed;
+            continue;
+        }
+
+        const fs::path output = output_dir / fs::path(level::compiledPath(tmx.filename().string()));
+        std::ofstream file(output, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!file) {
+            std::fprintf(stderr, "level-compiler: can't write %s\n", output.string().c_str());
+            ++failed;
+            continue;
+        }
+
+        std::printf("%s -> %s, %zu bytes\n", tmx.filename().string().c_str(), output.filename().string().c_str(), data.size());
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// touches everything the scene loader reads, including property conversion
+size_t walkLevel(const level::LevelView& view) {
+    size_t checksum = 0;
+    const uint16_t* tiles = view.tiles();
+    for (size_t i = 0; i < view.tileCount(); ++i) {
+        checksum += tiles[i];
+    }
+
+    for (uint32_t i = 0; i < view.objectCount(); ++i) {
+        const level::ObjectRecord& object = view.objects()[i];
+        checksum += view.typeName(object.type).size();
+
+        const level::PropertyRecord* properties = view.properties(object);
+        for (uint32_t p = 0; p < object.property_count; ++p) {
+            const std::string name(view.string(properties[p].name));
+            checksum += name.size() + view.toProperty(properties[p]).isValid();
+        }
+    }
+
+    return checksum;
+}
+
+int benchmark(const fs::path& dir, int iterations) {
+    using Clock = std::chrono::steady_clock;
+    double total_tmx = 0.0;
+    double total_compiled = 0.0;
+    size_t checksum = 0;
+
+    std::printf("%-20s %12s %12s %8s\n", "level", "tmx, us", "lvl, us", "speedup");
+
+    for (const auto& tmx : findLevels(dir)) {
+        const std::string compiled_path = level::compiledPath(tmx.string());
+        if (!fs::exists(compiled_path)) {
+            std::fprintf(stderr, "level-compiler: %s isn't compiled, skipped\n", tmx.filename().string().c_str());
+            continue;
+        }
+
+        auto start = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            std::vector<uint8_t> data;
+            level::LevelView view;
+            if (level::compileTmx(tmx.string(), data) && view.open(data.data(), data.size())) {
+                checksum += walkLevel(view);
+            }
+        }
+        const double tmx_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+        start = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            MappedFile file(compiled_path);
+            level::LevelView view;
+            if (view.open(file.data(), file.size())) {
+                checksum += walkLevel(view);
+            }
+        }
+        const double compiled_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+        total_tmx += tmx_us;
+        total_compiled += compiled_us;
+        std::printf("%-20s %12.1f %12.1f %7.1fx\n", tmx.stem().string().c_str(), tmx_us, compiled_us, tmx_us / compiled_us);
+    }
+
+    if (total_compiled > 0.0) {
+        std::printf("%-20s %12.1f %12.1f %7.1fx\n", "total", total_tmx, total_compiled, total_tmx / total_compiled);
+    }
+    std::printf("(checksum %zu)\n", checksum);
+    return EXIT_SUCCESS;
+}
+
+// tile parsing as it was before parseTileCsv, kept for comparison
+std::vector<char> legacyParseTiles(const char* text) {
+    std::string blocks_indexes_string = text;
+    std::vector<char> blockData;
+    std::string buf;
+
+    for (auto chr : blocks_indexes_string) {
+        if (isdigit(chr)) {
+            buf += chr;
+        } else if (!buf.empty()) {
+            blockData.push_back((char)utils::toInt(buf));
+            buf.clear();
+        }
+    }
+
+    return blockData;
+}
+
+int parseBenchmark(const fs::path& dir, int iterations) {
+    using Clock = std::chrono::steady_clock;
+    auto us = [](Clock::time_point from) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - from).count();
+    };
+
+    double total_read = 0.0, total_xml = 0.0, total_legacy = 0.0, total_tiles = 0.0;
+    size_t checksum = 0;
+    int levels = 0;
+
+    std::printf("%-20s %10s %10s %12s %10s\n", "level", "read, us", "xml, us", "legacy, us", "tiles, us");
+
+    for (const auto& tmx : findLevels(dir)) {
+        double read_us = 0.0, xml_us = 0.0, legacy_us = 0.0, tiles_us = 0.0;
+
+        for (int i = 0; i < iterations; ++i) {
+            auto start = Clock::now();
+            std::ifstream file(tmx, std::ios::binary);
+            const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            read_us += us(start);
+
+            start = Clock::now();
+            tinyxml2::XMLDocument document;
+            document.Parse(text.data(), text.size());
+            xml_us += us(start);
+
+            tinyxml2::XMLElement* map = document.FirstChildElement("map");
+            tinyxml2::XMLElement* layer = map ? map->FirstChildElement("layer") : nullptr;
+            tinyxml2::XMLElement* data = layer ? layer->FirstChildElement("data") : nullptr;
+            if (!data || !data->GetText()) {
+                continue;
+            }
+
+            start = Clock::now();
+            checksum += legacyParseTiles(data->GetText()).size();
+            legacy_us += us(start);
+
+            start = Clock::now();
+            std::vector<uint16_t> tiles(size_t(map->IntAttribute("width")) * map->IntAttribute("height"));
+            checksum += level::parseTileCsv(data->GetText(), tiles.data(), tiles.size()) ? tiles.size() : 0;
+            tiles_us += us(start);
+        }
+
+        read_us /= iterations;
+        xml_us /= iterations;
+        legacy_us /= iterations;
+        tiles_us /= iterations;
+        std::printf("%-20s %10.1f %10.1f %12.1f %10.1f\n", tmx.stem().string().c_str(), read_us, xml_us, legacy_us, tiles_us);
+
+        total_read += read_us;
+        total_xml += xml_us;
+        total_legacy += legacy_us;
+        total_tiles += tiles_us;
+        ++levels;
+    }
+
+    std::printf("%-20s %10.1f %10.1f %12.1f %10.1f\n", "total", total_read, total_xml, total_legacy, total_tiles);
+    std::printf("%d levels, tile parse is %.1f%% of file read (checksum %zu)\n",
+        levels, total_read > 0.0 ? total_tiles * 100.0 / total_read : 0.0, checksum);
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 2 && !std::strcmp(argv[1], "--benchmark")) {
+        const int iterations = (argc > 3) ? std::max(1, std::atoi(argv[3])) : 100;
+        return benchmark(argv[2], iterations);
+    }
+
+    if (argc > 2 && !std::strcmp(argv[1], "--parse-benchmark")) {
+        const int iterations = (argc > 3) ? std::max(1, std::atoi(argv[3])) : 100;
+        return parseBenchmark(argv[2], iterations);
+    }
+
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: level-compiler <levels dir> [output dir]\n"
+                             "       level-compiler --benchmark <levels dir> [iterations]\n"
+                             "       level-compiler --parse-benchmark <levels dir> [iterations]\n");
+        return EXIT_FAILURE;
+    }
+
+    return compileLevels(argv[1], (argc > 2) ? argv[2] : argv[1]);
+}